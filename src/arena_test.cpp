@@ -0,0 +1,173 @@
+#include "include/arena.h"
+#include <gtest/gtest.h>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "include/list.h"
+#include "include/unordered_map.h"
+#include "include/vector.h"
+
+namespace STL {
+
+TEST(ArenaTests, TestArena) {
+  auto pool = arena(1024);
+  ASSERT_EQ(pool.bytes_reserved(), 0);
+
+  auto p1 = pool.allocate(1, 1);
+  auto p2 = pool.allocate(8, 8);
+  auto p3 = pool.allocate(100, 64);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(p2) % 8, 0);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(p3) % 64, 0);
+  ASSERT_NE(p1, p2);
+  ASSERT_EQ(pool.bytes_used(), 109);
+
+  // larger than a block
+  auto p4 = static_cast<char *>(pool.allocate(4096));
+  p4[4095] = 'x';
+  ASSERT_GE(pool.bytes_reserved(), 1024 + 4096);
+
+  pool.release();
+  ASSERT_EQ(pool.bytes_used(), 0);
+  ASSERT_EQ(pool.bytes_reserved(), 0);
+}
+
+TEST(ArenaTests, TestVector) {
+  auto other_pool = arena();
+  auto pool = arena();
+  auto alloc = arena_allocator<int>(pool);
+  auto vec = vector<int, growth::doubling, arena_allocator<int>>(alloc);
+  auto vec_ref = std::vector<int>();
+  for (auto i = 0; i < 1000; i++) {
+    vec.push_back(i);
+    vec_ref.push_back(i);
+  }
+  ASSERT_EQ(vec.size(), vec_ref.size());
+  for (size_t i = 0; i < vec.size(); i++) {
+    ASSERT_EQ(vec[i], vec_ref[i]);
+  }
+  ASSERT_TRUE(vec.get_allocator() == alloc);
+  ASSERT_GE(pool.bytes_used(), 1000 * sizeof(int));
+
+  // copies stay in the same arena
+  auto vec_c = vec;
+  ASSERT_TRUE(vec_c.get_allocator() == alloc);
+  ASSERT_TRUE(vec_c == vec);
+
+  // move assignment and swap carry the arena along
+  auto vec_o = vector<int, growth::doubling, arena_allocator<int>>(arena_allocator<int>(other_pool));
+  vec_o.push_back(-1);
+  vec_o.swap(vec_c);
+  ASSERT_EQ(vec_o.get_allocator().resource(), &pool);
+  ASSERT_EQ(vec_c.get_allocator().resource(), &other_pool);
+  ASSERT_EQ(vec_c[0], -1);
+  vec_c = std::move(vec_o);
+  ASSERT_EQ(vec_c.get_allocator().resource(), &pool);
+  ASSERT_TRUE(vec_c == vec);
+}
+
+TEST(ArenaTests, TestList) {
+  // arenas must outlive every list holding their memory
+  auto other_pool = arena();
+  auto pool = arena();
+  using arena_list = list<std::string, arena_allocator<std::string>>;
+  auto lst = arena_list(arena_allocator<std::string>(pool));
+  auto lst_ref = std::list<std::string>();
+  for (auto i = 0; i < 100; i++) {
+    lst.push_back(std::to_string(i));
+    lst_ref.push_back(std::to_string(i));
+    lst.push_front(std::to_string(-i));
+    lst_ref.push_front(std::to_string(-i));
+  }
+  lst.pop_front();
+  lst_ref.pop_front();
+  auto check = [](arena_list &lst, std::list<std::string> &lst_ref) {
+    ASSERT_EQ(lst.size(), lst_ref.size());
+    auto itr_ref = lst_ref.begin();
+    for (auto itr = lst.begin(); itr != lst.end(); itr++, itr_ref++) {
+      ASSERT_EQ(*itr, *itr_ref);
+    }
+  };
+  check(lst, lst_ref);
+  auto used = pool.bytes_used();
+  ASSERT_GT(used, 0);
+
+  auto lst_c = lst;
+  check(lst_c, lst_ref);
+  ASSERT_EQ(lst_c.get_allocator().resource(), &pool);
+  ASSERT_GT(pool.bytes_used(), used);
+
+  auto lst_o = arena_list(arena_allocator<std::string>(other_pool));
+  lst_o.push_back("other");
+  lst_o = std::move(lst_c);
+  ASSERT_EQ(lst_o.get_allocator().resource(), &pool);
+  check(lst_o, lst_ref);
+}
+
+TEST(ArenaTests, TestListTeardown) {
+  static_assert(is_noop_deallocate_v<arena_allocator<int>>);
+  static_assert(!is_noop_deallocate_v<std::allocator<int>>);
+  auto pool = arena();
+  {
+    // ints in an arena: clear and the destructor drop the nodes without visiting them
+    auto lst = list<int, arena_allocator<int>>(arena_allocator<int>(pool));
+    for (auto i = 0; i < 100000; i++) {
+      lst.push_back(i);
+    }
+    auto used = pool.bytes_used();
+    lst.clear();
+    ASSERT_TRUE(lst.empty());
+    ASSERT_EQ(lst.begin(), lst.end());
+    ASSERT_EQ(pool.bytes_used(), used);
+    lst.push_back(1);
+    lst.push_front(0);
+    ASSERT_EQ(lst.size(), 2);
+    ASSERT_EQ(*lst.begin(), 0);
+    ASSERT_EQ(*(--lst.end()), 1);
+  }
+  {
+    // strings in an arena still get destroyed (ASan reports their buffers otherwise)
+    auto lst = list<std::string, arena_allocator<std::string>>(arena_allocator<std::string>(pool));
+    for (auto i = 0; i < 1000; i++) {
+      lst.push_back(std::string(64, 'a' + i % 26));
+    }
+    lst.clear();
+    ASSERT_TRUE(lst.empty());
+    lst.push_back(std::string(64, 'z'));
+  }
+}
+
+TEST(ArenaTests, TestUnorderedMap) {
+  using kv_t = std::pair<const std::string, int>;
+  using arena_map = unordered_map<std::string, int, std::hash<std::string>, arena_allocator<kv_t>>;
+  auto pool = arena();
+  auto map = arena_map(arena_allocator<kv_t>(pool));
+  auto map_ref = std::unordered_map<std::string, int>();
+  for (auto i = 0; i < 1000; i++) {
+    map.insert({std::to_string(i), i});
+    map_ref.insert({std::to_string(i), i});
+  }
+  map.erase(map.find("500"));
+  map_ref.erase("500");
+  ASSERT_EQ(map.size(), map_ref.size());
+  for (auto &kv : map_ref) {
+    ASSERT_EQ(map.at(kv.first), kv.second);
+  }
+  ASSERT_EQ(map.find("500"), map.end());
+  ASSERT_EQ(map.get_allocator().resource(), &pool);
+
+  auto map_c = map;
+  ASSERT_EQ(map_c.get_allocator().resource(), &pool);
+  for (auto &kv : map_ref) {
+    ASSERT_EQ(map_c.at(kv.first), kv.second);
+  }
+
+  auto map_m = std::move(map_c);
+  ASSERT_EQ(map_m.size(), map_ref.size());
+  ASSERT_EQ(map_c.size(), 0);
+  map_c.insert({"a", 1});
+  ASSERT_EQ(map_c.at("a"), 1);
+  ASSERT_EQ(map_m.at("999"), 999);
+}
+
+}  // namespace STL
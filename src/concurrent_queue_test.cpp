@@ -0,0 +1,251 @@
+#include "include/concurrent_queue.h"
+#include "include/list.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace STL {
+
+struct no_default {
+  int v_;
+  explicit no_default(int v) : v_(v) {}
+};
+
+TEST(ConcurrentQueueTests, TestSingleThread) {
+  auto queue = concurrent_queue<std::string>();
+  auto out = std::string();
+  ASSERT_TRUE(queue.empty());
+  ASSERT_FALSE(queue.try_pop(out));
+
+  ASSERT_TRUE(queue.try_push("a"));
+  queue.push(std::string("b"));
+  auto batch = std::vector<std::string>({"c", "d", "e"});
+  queue.push(batch.begin(), batch.end());
+  queue.push(batch.end(), batch.end());
+  ASSERT_TRUE(queue.try_emplace(3, 'f'));
+  ASSERT_FALSE(queue.empty());
+
+  ASSERT_TRUE(queue.try_pop(out));
+  ASSERT_EQ(out, "a");
+  auto popped = std::vector<std::string>();
+  ASSERT_EQ(queue.pop(std::back_inserter(popped), 3), 3);
+  ASSERT_EQ(popped, std::vector<std::string>({"b", "c", "d"}));
+  popped.clear();
+  ASSERT_EQ(queue.pop(std::back_inserter(popped), 10), 2);
+  ASSERT_EQ(popped, std::vector<std::string>({"e", "fff"}));
+  ASSERT_TRUE(queue.empty());
+
+  // elements left behind are destroyed with the queue
+  queue.push(std::string(100, 'x'));
+  queue.push(std::string(100, 'y'));
+
+  // bulk pop moves the values out, T needs no default constructor
+  auto ids = concurrent_queue<no_default>();
+  ids.push(no_default(1));
+  ASSERT_TRUE(ids.try_emplace(2));
+  auto ids_out = std::vector<no_default>();
+  ASSERT_EQ(ids.pop(std::back_inserter(ids_out), 5), 2);
+  ASSERT_EQ(ids_out[0].v_, 1);
+  ASSERT_EQ(ids_out[1].v_, 2);
+}
+
+// moves without throwing, but its move assignment throws, and so does its copy once copies_left reaches 0
+struct throwing_assign {
+  static inline int alive = 0;
+  static inline int copies_left = -1;
+
+  std::string s_;
+  explicit throwing_assign(std::string s) : s_(std::move(s)) { alive++; }
+  throwing_assign(const throwing_assign &other) : s_(other.s_) {
+    if (copies_left == 0) {
+      throw std::exception();
+    }
+    copies_left--;
+    alive++;
+  }
+  throwing_assign(throwing_assign &&other) noexcept : s_(std::move(other.s_)) { alive++; }
+  ~throwing_assign() { alive--; }
+  throwing_assign &operator=(throwing_assign && /* other */) { throw std::exception(); }
+};
+
+TEST(ConcurrentQueueTests, TestThrowingTake) {
+  auto queue = concurrent_queue<throwing_assign>();
+  queue.push(throwing_assign(std::string(100, 'a')));
+  queue.push(throwing_assign(std::string(100, 'b')));
+  auto out = throwing_assign("");
+  // the front element is dropped, its node and hazard released
+  ASSERT_THROW(queue.try_pop(out), std::exception);
+  auto popped = std::vector<throwing_assign>();
+  ASSERT_EQ(queue.pop(std::back_inserter(popped), 5), 1);
+  ASSERT_EQ(popped[0].s_, std::string(100, 'b'));
+  ASSERT_TRUE(queue.empty());
+
+  // a batch whose copy fails is not pushed at all
+  auto batch = std::vector<throwing_assign>(5, throwing_assign(std::string(100, 'c')));
+  auto alive = throwing_assign::alive;
+  throwing_assign::copies_left = 3;
+  ASSERT_THROW(queue.push(batch.begin(), batch.end()), std::exception);
+  throwing_assign::copies_left = -1;
+  ASSERT_TRUE(queue.empty());
+  ASSERT_EQ(throwing_assign::alive, alive);
+}
+
+TEST(ConcurrentQueueTests, TestStress) {
+  const int producers = 4;
+  const int consumers = 4;
+  const int per_producer = 50000;
+  auto queue = concurrent_queue<std::unique_ptr<int>>();
+  auto seen = std::vector<std::atomic<int>>(producers * per_producer);
+  auto done = std::atomic<int>(0);
+  auto order_ok = std::atomic<bool>(true);
+
+  auto threads = std::vector<std::thread>();
+  for (auto p = 0; p < producers; p++) {
+    threads.emplace_back([&, p] {
+      for (auto i = 0; i < per_producer; i += 10) {
+        if (i % 20 == 0) {
+          auto batch = std::vector<std::unique_ptr<int>>();
+          for (auto j = i; j < i + 10; j++) {
+            batch.push_back(std::make_unique<int>(p * per_producer + j));
+          }
+          queue.push(std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+        } else {
+          for (auto j = i; j < i + 10; j++) {
+            while (!queue.try_push(std::make_unique<int>(p * per_producer + j))) {
+            }
+          }
+        }
+      }
+    });
+  }
+  for (auto c = 0; c < consumers; c++) {
+    threads.emplace_back([&] {
+      // what this consumer saw last of each producer: the order of one producer is kept
+      auto last = std::vector<int>(producers, -1);
+      auto out = std::unique_ptr<int>();
+      while (done.load() < producers * per_producer) {
+        if (!queue.try_pop(out)) {
+          continue;
+        }
+        auto v = *out;
+        auto p = v / per_producer;
+        if (v <= last[p]) {
+          order_ok = false;
+        }
+        last[p] = v;
+        seen[v]++;
+        done++;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_TRUE(order_ok.load());
+  for (auto &count : seen) {
+    ASSERT_EQ(count.load(), 1);
+  }
+  ASSERT_TRUE(queue.empty());
+}
+
+TEST(ConcurrentQueueTests, TestBatches) {
+  // batches of one producer come out contiguous
+  const int producers = 4;
+  const int batches = 2000;
+  auto queue = concurrent_queue<int>();
+  auto threads = std::vector<std::thread>();
+  for (auto p = 0; p < producers; p++) {
+    threads.emplace_back([&, p] {
+      auto batch = std::vector<int>(8);
+      for (auto b = 0; b < batches; b++) {
+        for (auto j = 0; j < 8; j++) {
+          batch[j] = (p * batches + b) * 8 + j;
+        }
+        queue.push(batch.begin(), batch.end());
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto all = std::vector<int>();
+  ASSERT_EQ(queue.pop(std::back_inserter(all), producers * batches * 8 + 1), producers * batches * 8);
+  for (size_t i = 0; i < all.size(); i += 8) {
+    for (auto j = 0; j < 8; j++) {
+      ASSERT_EQ(all[i + j], all[i] + j);
+    }
+  }
+}
+
+// the list wrapped in a mutex, what concurrent_queue replaces
+template <typename T>
+class locked_list {
+ public:
+  void push(const T &value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    list_.push_back(value);
+  }
+
+  bool try_pop(T &out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (list_.empty()) {
+      return false;
+    }
+    out = *list_.begin();
+    list_.pop_front();
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  list<T> list_;
+};
+
+// push and pop total ints with as many producers as consumers, returns the seconds taken
+template <typename Queue>
+double run_throughput(Queue &queue, int threads, int total) {
+  auto popped = std::atomic<int>(0);
+  auto start = std::chrono::steady_clock::now();
+  auto workers = std::vector<std::thread>();
+  for (auto t = 0; t < threads; t++) {
+    workers.emplace_back([&] {
+      for (auto i = 0; i < total / threads; i++) {
+        queue.push(i);
+      }
+    });
+    workers.emplace_back([&] {
+      auto out = 0;
+      while (popped.load() < total / threads * threads) {
+        if (queue.try_pop(out)) {
+          popped++;
+        }
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+TEST(ConcurrentQueueTests, TestThroughput) {
+  const int total = 400000;
+  for (auto threads : {1, 4, 16}) {
+    auto queue = concurrent_queue<int>();
+    auto locked = locked_list<int>();
+    auto lock_free = run_throughput(queue, threads, total);
+    auto mutex = run_throughput(locked, threads, total);
+    std::cout << threads << " producers + " << threads << " consumers: concurrent_queue " << total / lock_free / 1e6
+              << " Mops/s, list + mutex " << total / mutex / 1e6 << " Mops/s" << std::endl;
+    ASSERT_TRUE(queue.empty());
+  }
+}
+
+}  // namespace STL
@@ -0,0 +1,176 @@
+#include "include/concurrent_unordered_map.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace STL {
+
+TEST(ConcurrentUnorderedMapTests, TestSingleThread) {
+  auto map = concurrent_unordered_map<std::string, int>(5);
+  ASSERT_EQ(map.shard_count(), 8);
+  ASSERT_TRUE(map.empty());
+
+  ASSERT_TRUE(map.insert_or_assign("a", 1));
+  ASSERT_FALSE(map.insert_or_assign("a", 2));
+  ASSERT_TRUE(map.try_emplace("b", 3));
+  ASSERT_FALSE(map.try_emplace("b", 4));
+  for (auto i = 0; i < 100; i++) {
+    map.insert_or_assign(std::to_string(i), i);
+  }
+  ASSERT_EQ(map.size(), 102);
+
+  auto value = 0;
+  ASSERT_TRUE(map.find_and_apply("a", [&value](const int &v) { value = v; }));
+  ASSERT_EQ(value, 2);
+  ASSERT_FALSE(map.find_and_apply("c", [&value](const int &v) { value = v; }));
+  ASSERT_TRUE(map.find_and_modify("b", [](int &v) { v *= 10; }));
+  ASSERT_TRUE(map.find_and_apply("b", [&value](const int &v) { value = v; }));
+  ASSERT_EQ(value, 30);
+  ASSERT_TRUE(map.contains("42"));
+  ASSERT_FALSE(map.contains("100"));
+
+  ASSERT_TRUE(map.erase("a"));
+  ASSERT_FALSE(map.erase("a"));
+  ASSERT_EQ(map.erase_if([](const auto &kv) { return kv.second % 2 == 1; }), 50);
+  ASSERT_EQ(map.size(), 51);
+  ASSERT_FALSE(map.contains("41"));
+  ASSERT_TRUE(map.contains("42"));
+
+  // the shards hold every entry once
+  auto sum = 0;
+  auto entries = size_t(0);
+  map.for_each_shard([&](const auto &shard) {
+    for (auto itr = shard.begin(); itr != shard.end(); itr++) {
+      sum += itr->second;
+    }
+    entries += shard.size();
+  });
+  ASSERT_EQ(entries, 51);
+  ASSERT_EQ(sum, 2480);
+
+  map.clear();
+  ASSERT_TRUE(map.empty());
+}
+
+TEST(ConcurrentUnorderedMapTests, TestStress) {
+  // every thread increments every counter: no increment is lost
+  const int threads = 8;
+  const int keys = 1000;
+  const int rounds = 20;
+  auto map = concurrent_unordered_map<int, int>(16);
+  auto workers = std::vector<std::thread>();
+  for (auto t = 0; t < threads; t++) {
+    workers.emplace_back([&, t] {
+      for (auto r = 0; r < rounds; r++) {
+        for (auto k = 0; k < keys; k++) {
+          auto key = (k + t * 97) % keys;
+          if (!map.find_and_modify(key, [](int &v) { v++; })) {
+            // another thread may insert it in between
+            if (!map.try_emplace(key, 1)) {
+              map.find_and_modify(key, [](int &v) { v++; });
+            }
+          }
+          map.find_and_apply(key, [](const int &v) { ASSERT_GT(v, 0); });
+        }
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  ASSERT_EQ(map.size(), keys);
+  for (auto k = 0; k < keys; k++) {
+    auto value = 0;
+    ASSERT_TRUE(map.find_and_apply(k, [&value](const int &v) { value = v; }));
+    ASSERT_EQ(value, threads * rounds);
+  }
+
+  // erase_if while other threads insert: erased and left entries add up
+  auto inserter = std::thread([&] {
+    for (auto k = keys; k < 2 * keys; k++) {
+      map.insert_or_assign(k, k);
+    }
+  });
+  auto erased = map.erase_if([](const auto &kv) { return kv.first % 2 == 0; });
+  inserter.join();
+  ASSERT_EQ(map.size() + erased, 2 * keys);
+}
+
+// the unordered_map wrapped in one mutex, what concurrent_unordered_map replaces
+template <typename Key, typename T>
+class locked_map {
+ public:
+  template <typename F>
+  bool find_and_apply(const Key &key, F &&f) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto itr = map_.find(key);
+    if (itr == map_.end()) {
+      return false;
+    }
+    f(itr->second);
+    return true;
+  }
+
+  bool insert_or_assign(const Key &key, const T &value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return map_.insert_or_assign(key, value).second;
+  }
+
+ private:
+  std::mutex mutex_;
+  unordered_map<Key, T> map_;
+};
+
+// total operations over keys, 90% lookups and 10% insert_or_assign, returns the seconds taken
+template <typename Map>
+double run_mixed(Map &map, int threads, int total, int keys) {
+  auto start = std::chrono::steady_clock::now();
+  auto workers = std::vector<std::thread>();
+  for (auto t = 0; t < threads; t++) {
+    workers.emplace_back([&, t] {
+      auto rng = std::mt19937(t);
+      // every key is there: every lookup finds it
+      auto reads = 0;
+      auto found = 0;
+      for (auto i = 0; i < total / threads; i++) {
+        auto key = static_cast<int>(rng() % keys);
+        if (rng() % 10 == 0) {
+          map.insert_or_assign(key, i);
+        } else {
+          reads++;
+          map.find_and_apply(key, [&found](const int & /* value */) { found++; });
+        }
+      }
+      ASSERT_EQ(found, reads);
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+TEST(ConcurrentUnorderedMapTests, TestThroughput) {
+  const int total = 400000;
+  const int keys = 10000;
+  for (auto threads : {1, 4, 16, 64}) {
+    auto sharded = concurrent_unordered_map<int, int>();
+    auto locked = locked_map<int, int>();
+    for (auto k = 0; k < keys; k++) {
+      sharded.insert_or_assign(k, k);
+      locked.insert_or_assign(k, k);
+    }
+    auto sharded_time = run_mixed(sharded, threads, total, keys);
+    auto locked_time = run_mixed(locked, threads, total, keys);
+    std::cout << threads << " threads, 90% reads: concurrent_unordered_map " << total / sharded_time / 1e6
+              << " Mops/s, unordered_map + mutex " << total / locked_time / 1e6 << " Mops/s" << std::endl;
+    ASSERT_EQ(sharded.size(), keys);
+  }
+}
+
+}  // namespace STL
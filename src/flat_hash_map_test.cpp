@@ -0,0 +1,166 @@
+#include "include/flat_hash_map.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+namespace STL {
+
+template <typename Key, typename T>
+void check_equal(const flat_hash_map<Key, T> &map, const std::unordered_map<Key, T> &map_ref) {
+  ASSERT_EQ(map.size(), map_ref.size());
+  auto tmp_map = std::unordered_map<Key, T>();
+  for (auto itr = map.begin(); itr != map.end(); itr++) {
+    tmp_map[itr->first] = itr->second;
+  }
+  ASSERT_EQ(tmp_map, map_ref);
+}
+
+TEST(FlatHashMapTests, TestConstructor) {
+  auto map1 = flat_hash_map<std::string, int>();
+  ASSERT_TRUE(map1.empty());
+  ASSERT_EQ(map1.begin(), map1.end());
+  ASSERT_EQ(map1.find("a"), map1.end());
+  ASSERT_EQ(map1.count("a"), 0);
+
+  auto map2 = flat_hash_map<std::string, int>({{"a", 1}, {"b", 2}, {"c", 3}, {"c", 4}, {"d", 4}, {"e", 5}});
+  auto map2_ref = std::unordered_map<std::string, int>({{"a", 1}, {"b", 2}, {"c", 3}, {"c", 4}, {"d", 4}, {"e", 5}});
+  check_equal(map2, map2_ref);
+
+  auto map3 = map2;
+  check_equal(map3, map2_ref);
+  auto map4 = std::move(map2);
+  check_equal(map4, map2_ref);
+  ASSERT_TRUE(map2.empty());
+  map2 = map4;
+  check_equal(map2, map2_ref);
+  map3 = std::move(map4);
+  check_equal(map3, map2_ref);
+  map3.swap(map4);
+  ASSERT_TRUE(map3.empty());
+  check_equal(map4, map2_ref);
+}
+
+TEST(FlatHashMapTests, TestModifier) {
+  auto map = flat_hash_map<std::string, int>();
+  auto [itr, inserted] = map.insert({"a", 1});
+  ASSERT_TRUE(inserted);
+  ASSERT_EQ(itr->second, 1);
+  std::tie(itr, inserted) = map.insert({"a", 2});
+  ASSERT_FALSE(inserted);
+  ASSERT_EQ(itr->second, 1);
+
+  map["b"] = 2;
+  map["c"]++;
+  ASSERT_EQ(map.at("b"), 2);
+  ASSERT_EQ(map.at("c"), 1);
+  ASSERT_THROW(map.at("d"), std::exception);
+  ASSERT_EQ(map.size(), 3);
+
+  map.erase(map.find("a"));
+  ASSERT_EQ(map.erase("b"), 1);
+  ASSERT_EQ(map.erase("b"), 0);
+  ASSERT_EQ(map.size(), 1);
+  ASSERT_EQ(map.find("a"), map.end());
+
+  // a const map is iterated and searched through const_iterator
+  using map_t = flat_hash_map<std::string, int>;
+  static_assert(std::is_same_v<decltype(*std::declval<const map_t &>().begin()), const map_t::kv_t &>);
+  static_assert(std::is_convertible_v<map_t::iterator, map_t::const_iterator>);
+  static_assert(!std::is_convertible_v<map_t::const_iterator, map_t::iterator>);
+  const auto &map_c = map;
+  ASSERT_EQ(map_c.find("c")->second, 1);
+  ASSERT_EQ(map_c.find("d"), map_c.end());
+  auto citr = map_c.begin();
+  ASSERT_EQ(citr++->first, "c");
+  ASSERT_EQ(citr, map_c.end());
+  ASSERT_EQ(map_t::const_iterator(map.find("c")), map_c.find("c"));
+
+  map.clear();
+  ASSERT_TRUE(map.empty());
+  ASSERT_EQ(map.begin(), map.end());
+  map["x"] = 24;
+  ASSERT_EQ(map.at("x"), 24);
+}
+
+TEST(FlatHashMapTests, TestRandom) {
+  auto map = flat_hash_map<int, int>();
+  auto map_ref = std::unordered_map<int, int>();
+  auto rng = std::mt19937(42);
+  // few keys, many erases: tombstones pile up and get cleaned
+  for (auto i = 0; i < 200000; i++) {
+    auto key = static_cast<int>(rng() % 3000);
+    switch (rng() % 4) {
+      case 0:
+        ASSERT_EQ(map.erase(key), map_ref.erase(key));
+        break;
+      case 1:
+        ASSERT_EQ(map.count(key), map_ref.count(key));
+        break;
+      default:
+        map[key] += i;
+        map_ref[key] += i;
+    }
+    ASSERT_EQ(map.size(), map_ref.size());
+  }
+  check_equal(map, map_ref);
+  ASSERT_LE(map.load_factor(), map.max_load_factor());
+  ASSERT_LE(map.bucket_count(), 8192);
+}
+
+TEST(FlatHashMapTests, TestCollisions) {
+  // every key in the same group with the same control byte: all slots are compared
+  struct bad_hash {
+    size_t operator()(int /* key */) const { return 0; }
+  };
+  auto map = flat_hash_map<int, int, bad_hash>();
+  for (auto i = 0; i < 100; i++) {
+    map[i] = i;
+  }
+  for (auto i = 0; i < 100; i += 2) {
+    map.erase(i);
+  }
+  for (auto i = 0; i < 100; i++) {
+    ASSERT_EQ(map.count(i), i % 2);
+  }
+  ASSERT_EQ(map.size(), 50);
+}
+
+TEST(FlatHashMapTests, TestReserve) {
+  auto map = flat_hash_map<int, std::unique_ptr<int>>();
+  map.reserve(1000);
+  auto capacity = map.bucket_count();
+  ASSERT_GE(capacity * map.max_load_factor(), 1000);
+  for (auto i = 0; i < 1000; i++) {
+    map.insert({i, std::make_unique<int>(i)});
+  }
+  ASSERT_EQ(map.bucket_count(), capacity);
+
+  // entries are moved, not copied, when the table grows
+  for (auto i = 1000; i < 5000; i++) {
+    map.insert({i, std::make_unique<int>(i)});
+  }
+  for (auto i = 0; i < 5000; i++) {
+    ASSERT_EQ(*map.at(i), i);
+  }
+  map.rehash(0);
+  ASSERT_EQ(*map.at(4999), 4999);
+}
+
+TEST(FlatHashMapTests, TestStringKeys) {
+  auto map = flat_hash_map<std::string, std::string>();
+  auto map_ref = std::unordered_map<std::string, std::string>();
+  for (auto i = 0; i < 1000; i++) {
+    // long enough to live on the heap, so that a moved-from key would be emptied
+    auto key = std::string(32, 'k') + std::to_string(i);
+    auto kv = std::pair<const std::string, std::string>(key, std::to_string(i));
+    map.insert(std::move(kv));
+    ASSERT_EQ(kv.first, key);
+    map_ref[key] = std::to_string(i);
+  }
+  check_equal(map, map_ref);
+}
+
+}  // namespace STL
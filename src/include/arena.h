@@ -0,0 +1,135 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace STL {
+
+/**
+ * A bump allocator: memory is carved out of large blocks by moving a pointer forward, deallocation is a no-op,
+ * and everything is given back at once by release() or the destructor.
+ *
+ * @details
+ * Containers whose elements die together (e.g. everything built while serving one request) can be backed by one
+ * arena and dropped in O(number of blocks) instead of freeing node by node. Not thread-safe.
+ */
+class arena {
+ public:
+  explicit arena(size_t block_size = 64 * 1024) : block_size_(block_size) {}
+
+  arena(const arena &) = delete;
+  arena &operator=(const arena &) = delete;
+
+  ~arena() { release(); }
+
+  void *allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+    auto p = align_up_(cur_, align);
+    if (cur_ == nullptr || p + bytes > end_) {
+      grow_(bytes + align);
+      p = align_up_(cur_, align);
+    }
+    cur_ = p + bytes;
+    used_ += bytes;
+    return p;
+  }
+
+  // give every block back, all memory handed out so far becomes invalid
+  void release() noexcept {
+    while (head_ != nullptr) {
+      auto prev = head_->prev_;
+      ::operator delete(head_);
+      head_ = prev;
+    }
+    cur_ = nullptr;
+    end_ = nullptr;
+    used_ = 0;
+    reserved_ = 0;
+  }
+
+  size_t bytes_used() const noexcept { return used_; }
+  size_t bytes_reserved() const noexcept { return reserved_; }
+
+ private:
+  struct block {
+    block *prev_;
+  };
+
+  block *head_{nullptr};  // the newest block, older ones are chained by prev_
+  char *cur_{nullptr};    // next free byte in head_
+  char *end_{nullptr};    // end of head_
+  size_t block_size_;
+  size_t used_{0};
+  size_t reserved_{0};
+
+  static char *align_up_(char *p, size_t align) {
+    auto addr = reinterpret_cast<uintptr_t>(p);
+    return reinterpret_cast<char *>((addr + align - 1) & ~(align - 1));
+  }
+
+  void grow_(size_t bytes) {
+    auto size = sizeof(block) + (bytes > block_size_ ? bytes : block_size_);
+    auto blk = static_cast<block *>(::operator new(size));
+    blk->prev_ = head_;
+    head_ = blk;
+    cur_ = reinterpret_cast<char *>(blk + 1);
+    end_ = reinterpret_cast<char *>(blk) + size;
+    reserved_ += size;
+  }
+};
+
+/**
+ * Allocator adaptor of arena for containers, e.g. list<int, arena_allocator<int>>.
+ * Copies (and rebinds) share the arena, and follow it on move assignment and swap.
+ */
+template <typename T>
+class arena_allocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+  using is_always_equal = std::false_type;
+
+  explicit arena_allocator(arena &arena) noexcept : arena_(&arena) {}
+
+  template <typename U>
+  arena_allocator(const arena_allocator<U> &other) noexcept : arena_(other.arena_) {}
+
+  T *allocate(size_t n) { return static_cast<T *>(arena_->allocate(n * sizeof(T), alignof(T))); }
+
+  void deallocate(T * /* p */, size_t /* n */) noexcept {}
+
+  arena *resource() const noexcept { return arena_; }
+
+  template <typename U>
+  bool operator==(const arena_allocator<U> &other) const noexcept {
+    return arena_ == other.arena_;
+  }
+
+  template <typename U>
+  bool operator!=(const arena_allocator<U> &other) const noexcept {
+    return arena_ != other.arena_;
+  }
+
+ private:
+  template <typename U>
+  friend class arena_allocator;
+
+  arena *arena_;
+};
+
+/**
+ * Whether Alloc::deallocate is a no-op. Containers skip the walk over their nodes on teardown when, in addition, the
+ * nodes need no destruction; specialize it for other allocators that release memory in bulk.
+ */
+template <typename Alloc>
+struct is_noop_deallocate : std::false_type {};
+
+template <typename T>
+struct is_noop_deallocate<arena_allocator<T>> : std::true_type {};
+
+template <typename Alloc>
+inline constexpr bool is_noop_deallocate_v = is_noop_deallocate<Alloc>::value;
+
+}  // namespace STL
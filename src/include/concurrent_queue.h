@@ -0,0 +1,244 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "hazard_pointer.h"
+#include "pool_allocator.h"
+
+namespace STL {
+
+/**
+ * Unbounded lock-free multi-producer multi-consumer FIFO queue (Michael & Scott, 1996), nodes are reclaimed with
+ * hazard pointers.
+ *
+ * @details
+ * Like list, it is a chain of nodes holding one T each, taken from node_pool as in pooled_list; head_ points to a
+ * dummy node whose successor holds the front element, tail_ to the last node or close behind it (any thread that
+ * finds it lagging moves it forward).
+ * <ul>
+ * <li>try_push/try_pop never block: a thread only retries when another one made progress.</li>
+ * <li>push(first, last) links its nodes privately and appends the whole chain with one CAS, so a batch is never
+ * interleaved with other producers; pop(out, max) pops one element at a time.</li>
+ * <li>Elements pushed by one thread are popped in the order they were pushed.</li>
+ * <li>A popped element is moved out of its node right after it is unlinked, so T must be nothrow move
+ * constructible; if handing it over throws afterwards (e.g. the move assignment of try_pop), it is dropped.</li>
+ * </ul>
+ * A node is published by the release CAS that links it (to the next_ of the last node) and read after the acquire
+ * load of that next_, so its value and links are visible to whoever reaches it. head_ and tail_ only move forward
+ * with release CASes, loaded with acquire; hazard_pointer orders its own publication.
+ */
+template <typename T>
+class concurrent_queue {
+  static_assert(std::is_nothrow_move_constructible_v<T>, "a popped element is moved out once it is unlinked");
+
+ private:
+  struct node {
+    std::atomic<node *> next_{nullptr};
+    alignas(T) unsigned char buf_[sizeof(T)];  // constructed for the nodes after the dummy
+
+    node() = default;
+
+    template <typename... Args>
+    explicit node(Args &&...args) {
+      ::new (static_cast<void *>(buf_)) T(std::forward<Args>(args)...);
+    }
+
+    T *value() { return reinterpret_cast<T *>(buf_); }
+  };
+
+  using pool_t = node_pool<sizeof(node), alignof(node)>;
+
+  alignas(64) std::atomic<node *> head_;  // the dummy, consumers move it forward
+  alignas(64) std::atomic<node *> tail_;  // the last node, or a node before it
+
+  template <typename... Args>
+  static node *new_node_(Args &&...args) {
+    auto p = pool_t::allocate();
+    try {
+      return ::new (p) node(std::forward<Args>(args)...);
+    } catch (...) {
+      pool_t::deallocate(p);
+      throw;
+    }
+  }
+
+  // the value, if any, is destroyed already
+  static void delete_node_(node *n) {
+    n->~node();
+    pool_t::deallocate(n);
+  }
+
+  // give n back to the pool once no hazard pointer protects it
+  static void retire_(node *n) {
+    hazard_domain::getInstance().retire(n, [](void *p) { delete_node_(static_cast<node *>(p)); });
+  }
+
+  // link the chain [first, last] after the last node
+  void append_(node *first, node *last) {
+    auto hp = hazard_pointer(0);
+    while (true) {
+      auto tail = hp.protect(tail_);
+      auto next = tail->next_.load(std::memory_order_acquire);
+      if (tail != tail_.load(std::memory_order_acquire)) {
+        continue;
+      }
+      if (next != nullptr) {
+        // tail_ is lagging, help it forward
+        tail_.compare_exchange_weak(tail, next, std::memory_order_release, std::memory_order_relaxed);
+        continue;
+      }
+      // release: publishes the chain, values and links included
+      if (tail->next_.compare_exchange_weak(next, first, std::memory_order_release, std::memory_order_relaxed)) {
+        tail_.compare_exchange_strong(tail, last, std::memory_order_release, std::memory_order_relaxed);
+        return;
+      }
+    }
+  }
+
+ public:
+  using value_type = T;
+
+  concurrent_queue() {
+    auto dummy = new_node_();
+    head_.store(dummy, std::memory_order_relaxed);
+    tail_.store(dummy, std::memory_order_relaxed);
+  }
+
+  concurrent_queue(const concurrent_queue &) = delete;
+  concurrent_queue &operator=(const concurrent_queue &) = delete;
+
+  // no other thread may use the queue anymore
+  ~concurrent_queue() {
+    auto curr = head_.load(std::memory_order_relaxed);
+    auto next = curr->next_.load(std::memory_order_relaxed);
+    delete_node_(curr);
+    for (curr = next; curr != nullptr; curr = next) {
+      next = curr->next_.load(std::memory_order_relaxed);
+      curr->value()->~T();
+      delete_node_(curr);
+    }
+  }
+
+  // never fails for want of room: the queue is unbounded; false only if no node can be allocated
+  bool try_push(const T &value) { return try_emplace(value); }
+  bool try_push(T &&value) { return try_emplace(std::move(value)); }
+
+  template <typename... Args>
+  bool try_emplace(Args &&...args) {
+    node *n;
+    try {
+      n = new_node_(std::forward<Args>(args)...);
+    } catch (const std::bad_alloc &) {
+      return false;
+    }
+    append_(n, n);
+    return true;
+  }
+
+  void push(const T &value) {
+    auto n = new_node_(value);
+    append_(n, n);
+  }
+
+  void push(T &&value) {
+    auto n = new_node_(std::move(value));
+    append_(n, n);
+  }
+
+  // push [first, last) as one contiguous batch; nothing is pushed if an element fails to copy
+  template <typename InputIt>
+  void push(InputIt first, InputIt last) {
+    if (first == last) {
+      return;
+    }
+    auto head = new_node_(*first);
+    auto tail = head;
+    try {
+      for (++first; first != last; ++first) {
+        auto n = new_node_(*first);
+        tail->next_.store(n, std::memory_order_relaxed);
+        tail = n;
+      }
+    } catch (...) {
+      // the chain is still private, nothing of the batch is pushed
+      for (auto curr = head; curr != nullptr;) {
+        auto next = curr->next_.load(std::memory_order_relaxed);
+        curr->value()->~T();
+        delete_node_(curr);
+        curr = next;
+      }
+      throw;
+    }
+    append_(head, tail);
+  }
+
+  // move the front element to out, false if the queue is empty; T must be move assignable
+  bool try_pop(T &out) {
+    return pop_([&](T &value) { out = std::move(value); });
+  }
+
+  // pop up to max elements into out, returns how many
+  template <typename OutputIt>
+  size_t pop(OutputIt out, size_t max) {
+    size_t count = 0;
+    for (; count < max; count++) {
+      auto popped = pop_([&](T &value) {
+        *out = std::move(value);
+        ++out;
+      });
+      if (!popped) {
+        break;
+      }
+    }
+    return count;
+  }
+
+  // a snapshot, stale as soon as it returns
+  bool empty() const {
+    auto hp = hazard_pointer(0);
+    auto head = hp.protect(head_);
+    return head->next_.load(std::memory_order_acquire) == nullptr;
+  }
+
+ private:
+  // unlink the front element and hand it to take(T &), false if the queue is empty
+  template <typename Take>
+  bool pop_(Take &&take) {
+    auto hp_head = hazard_pointer(0);
+    auto hp_next = hazard_pointer(1);
+    while (true) {
+      auto head = hp_head.protect(head_);
+      // acquire: pairs with the release CAS of append_, the value of next is visible
+      auto next = head->next_.load(std::memory_order_acquire);
+      hp_next.set(next);
+      // next is safe to use only if head is still the dummy
+      if (head != head_.load(std::memory_order_acquire)) {
+        continue;
+      }
+      if (next == nullptr) {
+        return false;
+      }
+      auto tail = tail_.load(std::memory_order_acquire);
+      if (head == tail) {
+        // tail_ is lagging, help it forward
+        tail_.compare_exchange_weak(tail, next, std::memory_order_release, std::memory_order_relaxed);
+        continue;
+      }
+      if (head_.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed)) {
+        // next is the new dummy, its value is ours alone: move it out (no throw) and release both nodes before
+        // handing it over, so that a throwing take leaves nothing behind
+        auto value = T(std::move(*next->value()));
+        next->value()->~T();
+        hp_next.reset();
+        hp_head.reset();
+        retire_(head);
+        take(value);
+        return true;
+      }
+    }
+  }
+};
+
+}  // namespace STL
@@ -0,0 +1,176 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include "unordered_map.h"
+
+namespace STL {
+
+/**
+ * Hash map shared by threads: the key space is split into shards, each an unordered_map behind its own reader/writer
+ * lock, so that threads working on different shards never wait for each other and readers of one shard only wait
+ * for its writers.
+ *
+ * @details
+ * <ul>
+ * <li>Every operation on a key is atomic: it holds the lock of the shard of the key (shared for lookups, exclusive
+ * for updates) for its whole duration, callbacks included. Callbacks must not use the map.</li>
+ * <li>Operations on the whole map (erase_if, for_each_shard, size, clear) lock one shard at a time: they are atomic
+ * per shard, not across shards.</li>
+ * <li>No reference to an entry escapes a lock: values are read and modified through callbacks.</li>
+ * </ul>
+ */
+template <typename Key, typename T, class Hash = std::hash<Key>>
+class concurrent_unordered_map {
+ public:
+  using map_t = unordered_map<Key, T, Hash>;
+  using kv_t = typename map_t::kv_t;
+
+  static constexpr size_t default_shards = 64;
+
+ private:
+  // a shard per cache line, so that the locks of two shards never share one
+  struct alignas(64) shard {
+    mutable std::shared_mutex mutex_;
+    map_t map_;
+  };
+
+  std::unique_ptr<shard[]> shards_;
+  size_t shard_count_;  // a power of 2
+  size_t shift_;        // 64 - log2(shard_count_)
+  Hash hash_func_{Hash()};
+
+  // the shard comes from the upper bits of the mixed hash, the map of the shard uses the lower ones of the hash
+  shard &shard_of_(const Key &key) const {
+    auto h = static_cast<uint64_t>(hash_func_(key)) * 0x9E3779B97F4A7C15ull;
+    return shards_[shift_ == 64 ? 0 : static_cast<size_t>(h >> shift_)];
+  }
+
+ public:
+  // shards is rounded up to a power of 2
+  explicit concurrent_unordered_map(size_t shards = default_shards) {
+    shard_count_ = 1;
+    shift_ = 64;
+    while (shard_count_ < shards) {
+      shard_count_ *= 2;
+      shift_--;
+    }
+    shards_ = std::make_unique<shard[]>(shard_count_);
+  }
+
+  concurrent_unordered_map(const concurrent_unordered_map &) = delete;
+  concurrent_unordered_map &operator=(const concurrent_unordered_map &) = delete;
+
+  // true if key was inserted, false if its value was assigned
+  template <typename M>
+  bool insert_or_assign(const Key &key, M &&obj) {
+    auto &s = shard_of_(key);
+    std::unique_lock<std::shared_mutex> lock(s.mutex_);
+    return s.map_.insert_or_assign(key, std::forward<M>(obj)).second;
+  }
+
+  // insert key with a value made of args, false (and nothing constructed) if key is there
+  template <typename... Args>
+  bool try_emplace(const Key &key, Args &&...args) {
+    auto &s = shard_of_(key);
+    std::unique_lock<std::shared_mutex> lock(s.mutex_);
+    return s.map_.try_emplace(key, std::forward<Args>(args)...).second;
+  }
+
+  // call f(const T &) on the value of key under a shared lock, false if key is absent
+  template <typename F>
+  bool find_and_apply(const Key &key, F &&f) const {
+    auto &s = shard_of_(key);
+    std::shared_lock<std::shared_mutex> lock(s.mutex_);
+    // the const find only reads: concurrent readers are safe
+    auto itr = s.map_.find(key);
+    if (itr == s.map_.end()) {
+      return false;
+    }
+    f(itr->second);
+    return true;
+  }
+
+  // call f(T &) on the value of key under an exclusive lock (an atomic read-modify-write), false if key is absent
+  template <typename F>
+  bool find_and_modify(const Key &key, F &&f) {
+    auto &s = shard_of_(key);
+    std::unique_lock<std::shared_mutex> lock(s.mutex_);
+    auto itr = s.map_.find(key);
+    if (itr == s.map_.end()) {
+      return false;
+    }
+    f(itr->second);
+    return true;
+  }
+
+  bool contains(const Key &key) const {
+    return find_and_apply(key, [](const T & /* value */) {});
+  }
+
+  // false if key is absent
+  bool erase(const Key &key) {
+    auto &s = shard_of_(key);
+    std::unique_lock<std::shared_mutex> lock(s.mutex_);
+    auto itr = s.map_.find(key);
+    if (itr == s.map_.end()) {
+      return false;
+    }
+    s.map_.erase(itr);
+    return true;
+  }
+
+  // erase the entries for which pred(const kv_t &) is true, returns how many
+  template <typename Pred>
+  size_t erase_if(Pred pred) {
+    size_t erased = 0;
+    for (size_t i = 0; i < shard_count_; i++) {
+      auto &s = shards_[i];
+      std::unique_lock<std::shared_mutex> lock(s.mutex_);
+      for (auto itr = s.map_.begin(); itr != s.map_.end();) {
+        auto next = itr;
+        ++next;
+        if (pred(static_cast<const kv_t &>(*itr))) {
+          s.map_.erase(itr);
+          erased++;
+        }
+        itr = next;
+      }
+    }
+    return erased;
+  }
+
+  // call f(const map_t &) on every shard in turn, each under a shared lock
+  template <typename F>
+  void for_each_shard(F &&f) const {
+    for (size_t i = 0; i < shard_count_; i++) {
+      auto &s = shards_[i];
+      std::shared_lock<std::shared_mutex> lock(s.mutex_);
+      f(static_cast<const map_t &>(s.map_));
+    }
+  }
+
+  // a sum over the shards, exact only if no thread modifies the map meanwhile
+  size_t size() const {
+    size_t size = 0;
+    for_each_shard([&size](const map_t &map) { size += map.size(); });
+    return size;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  void clear() {
+    for (size_t i = 0; i < shard_count_; i++) {
+      std::unique_lock<std::shared_mutex> lock(shards_[i].mutex_);
+      shards_[i].map_.clear();
+    }
+  }
+
+  size_t shard_count() const { return shard_count_; }
+};
+
+}  // namespace STL
@@ -0,0 +1,571 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "simd.h"
+
+#define DEBUG
+
+namespace STL {
+
+/**
+ * Open addressing hash map with the interface of unordered_map, in the manner of SwissTable: the entries sit in one
+ * array of slots, next to an array of one control byte per slot that tells whether the slot is empty, deleted (a
+ * tombstone) or full, and in the latter case 7 bits of the hash of its key.
+ *
+ * @details
+ * <ul>
+ * <li>Slots come in groups of 16. A lookup hashes once, then probes group by group (quadratically): the 16 control
+ * bytes of a group are compared to the 7 hash bits at once with SSE2, and only the slots that match compare keys. It
+ * stops at the first group with an empty slot.</li>
+ * <li>The table grows (doubles) when full slots and tombstones reach 7/8 of the capacity; tombstones are dropped at
+ * the same time.</li>
+ * <li>Inserting may move entries: a rehash invalidates iterators and references.</li>
+ * <li>A slot is a union of the kv_t handed out to users and a pair<Key, T> through which a rehash moves keys.</li>
+ * </ul>
+ */
+template <typename Key, typename T, class Hash = std::hash<Key>, class Alloc = std::allocator<std::pair<const Key, T>>>
+class flat_hash_map {
+ public:
+  using kv_t = std::pair<const Key, T>;
+  using value_type = kv_t;
+  using allocator_type = Alloc;
+
+  static constexpr size_t group_width = 16;
+
+ private:
+  // control bytes: full slots hold 7 bits of the hash, from 0 to 127
+  static constexpr int8_t empty_ = -128;
+  static constexpr int8_t deleted_ = -2;
+
+  struct alignas(group_width) ctrl_group {
+    int8_t ctrl_[group_width];
+  };
+
+  /* the 16 control bytes of a group, each query is a bit mask of the matching slots */
+  struct group {
+#ifdef STL_SIMD_X86
+    __m128i ctrl_;
+
+    explicit group(const int8_t *ctrl) : ctrl_(_mm_load_si128(reinterpret_cast<const __m128i *>(ctrl))) {}
+
+    uint32_t match(int8_t h2) const { return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl_, _mm_set1_epi8(h2))); }
+    uint32_t match_empty() const { return match(empty_); }
+    // empty and deleted have their sign bit set
+    uint32_t match_free() const { return _mm_movemask_epi8(ctrl_); }
+#else
+    const int8_t *ctrl_;
+
+    explicit group(const int8_t *ctrl) : ctrl_(ctrl) {}
+
+    uint32_t match(int8_t h2) const {
+      uint32_t mask = 0;
+      for (size_t i = 0; i < group_width; i++) {
+        mask |= static_cast<uint32_t>(ctrl_[i] == h2) << i;
+      }
+      return mask;
+    }
+    uint32_t match_empty() const { return match(empty_); }
+    uint32_t match_free() const {
+      uint32_t mask = 0;
+      for (size_t i = 0; i < group_width; i++) {
+        mask |= static_cast<uint32_t>(ctrl_[i] < 0) << i;
+      }
+      return mask;
+    }
+#endif
+  };
+
+ public:
+  // forward iterator over the full slots, V is kv_t or const kv_t
+  template <typename V>
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = kv_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = V *;
+    using reference = V &;
+
+    const flat_hash_map *map_{nullptr};
+    size_t idx_{0};
+
+   public:
+    Iterator() = default;
+    Iterator(const flat_hash_map *map, size_t idx) : map_(map), idx_(idx) {}
+    // iterator => const_iterator
+    template <typename U, typename = std::enable_if_t<std::is_same_v<V, const U>>>
+    Iterator(const Iterator<U> &other) : map_(other.map_), idx_(other.idx_) {}
+
+    V &operator*() const { return map_->entry_(idx_); }
+    V *operator->() const { return &map_->entry_(idx_); }
+    // ++itr
+    Iterator &operator++() {
+      idx_ = map_->next_full_(idx_ + 1);
+      return *this;
+    }
+    // itr++
+    Iterator operator++(int) {
+      auto old = *this;
+      ++*this;
+      return old;
+    }
+
+    bool operator==(const Iterator &other) const { return idx_ == other.idx_; }
+    bool operator!=(const Iterator &other) const { return idx_ != other.idx_; }
+  };
+
+  using iterator = Iterator<kv_t>;
+  using const_iterator = Iterator<const kv_t>;
+
+ private:
+  /**
+   * An entry is always constructed and destroyed as value. The key of value is const and could only be copied on
+   * rehash, so the rehash reads it through mutable_value, which has the same layout, to move it instead.
+   */
+  union slot_t {
+    kv_t value;
+    std::pair<Key, T> mutable_value;
+
+    slot_t() {}
+    ~slot_t() {}
+  };
+  static_assert(sizeof(std::pair<Key, T>) == sizeof(kv_t) && alignof(std::pair<Key, T>) == alignof(kv_t));
+
+  using ctrl_alloc_t = typename std::allocator_traits<Alloc>::template rebind_alloc<ctrl_group>;
+  using slot_alloc_t = typename std::allocator_traits<Alloc>::template rebind_alloc<slot_t>;
+  using ctrl_traits = std::allocator_traits<ctrl_alloc_t>;
+  using slot_traits = std::allocator_traits<slot_alloc_t>;
+
+  ctrl_alloc_t ctrl_alloc_;
+  slot_alloc_t slot_alloc_;
+  int8_t *ctrl_{nullptr};  // capacity_ control bytes
+  slot_t *slots_{nullptr};  // capacity_ slots, constructed where the control byte is full
+  size_t capacity_{0};     // 0 or a power of 2, at least group_width
+  size_t size_{0};
+  size_t growth_left_{0};  // empty slots that can still be filled before the table must grow
+
+  Hash hash_func_{Hash()};
+
+  static constexpr size_t max_load_(size_t capacity) { return capacity - capacity / 8; }
+
+  // spread the bits of the hash: the group comes from its upper bits, the 7 control bits from its lower ones
+  size_t hash_(const Key &key) const {
+    auto h = static_cast<uint64_t>(hash_func_(key)) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(h ^ (h >> 32));
+  }
+
+  // the entry of a full slot, as users see it
+  kv_t &entry_(size_t idx) const { return slots_[idx].value; }
+
+  static int8_t h2_(size_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+
+  static bool is_full_(int8_t ctrl) { return ctrl >= 0; }
+
+  // the first full slot from idx on, or capacity_
+  size_t next_full_(size_t idx) const {
+    while (idx < capacity_ && !is_full_(ctrl_[idx])) {
+      idx++;
+    }
+    return idx;
+  }
+
+  /* the sequence of groups probed for a hash: quadratic, visits every group once */
+  struct probe_seq {
+    size_t group_;
+    size_t mask_;
+    size_t step_{0};
+
+    probe_seq(size_t hash, size_t groups) : group_((hash >> 7) & (groups - 1)), mask_(groups - 1) {}
+
+    size_t offset() const { return group_ * group_width; }
+    void next() {
+      step_++;
+      group_ = (group_ + step_) & mask_;
+    }
+  };
+
+  // the slot of key, or capacity_
+  size_t get_(const Key &key, size_t hash) const {
+    if (capacity_ == 0) {
+      return capacity_;
+    }
+    auto h2 = h2_(hash);
+    for (auto seq = probe_seq(hash, capacity_ / group_width);; seq.next()) {
+      auto g = group(ctrl_ + seq.offset());
+      for (auto mask = g.match(h2); mask != 0; mask &= mask - 1) {
+        auto idx = seq.offset() + __builtin_ctz(mask);
+        if (slots_[idx].value.first == key) {
+          return idx;
+        }
+      }
+      if (g.match_empty() != 0) {
+        return capacity_;
+      }
+    }
+  }
+
+  // the first empty or deleted slot on the probe sequence of hash
+  size_t find_free_(size_t hash) const {
+    for (auto seq = probe_seq(hash, capacity_ / group_width);; seq.next()) {
+      auto mask = group(ctrl_ + seq.offset()).match_free();
+      if (mask != 0) {
+        return seq.offset() + __builtin_ctz(mask);
+      }
+    }
+  }
+
+  /**
+   * The slot of key and false if it is there, otherwise a free slot for it (the control byte already set, the slot
+   * not constructed) and true.
+   */
+  std::pair<size_t, bool> prepare_insert_(const Key &key) {
+    auto hash = hash_(key);
+    auto idx = get_(key, hash);
+    if (idx != capacity_) {
+      return {idx, false};
+    }
+    if (growth_left_ == 0) {
+      // lots of tombstones: clean them up at the same capacity, otherwise grow
+      rehash_(capacity_ == 0 ? group_width : (size_ * 2 < max_load_(capacity_) ? capacity_ : capacity_ * 2));
+    }
+    idx = find_free_(hash);
+    if (ctrl_[idx] == empty_) {
+      growth_left_--;
+    }
+    ctrl_[idx] = h2_(hash);
+    size_++;
+    return {idx, true};
+  }
+
+  // a table of capacity slots, all empty
+  void allocate_(size_t capacity) {
+    capacity_ = capacity;
+    growth_left_ = max_load_(capacity);
+    if (capacity == 0) {
+      ctrl_ = nullptr;
+      slots_ = nullptr;
+      return;
+    }
+    ctrl_ = reinterpret_cast<int8_t *>(ctrl_traits::allocate(ctrl_alloc_, capacity / group_width));
+    std::memset(ctrl_, empty_, capacity);
+    slots_ = slot_traits::allocate(slot_alloc_, capacity);
+  }
+
+  void deallocate_() {
+    if (capacity_ == 0) {
+      return;
+    }
+    ctrl_traits::deallocate(ctrl_alloc_, reinterpret_cast<ctrl_group *>(ctrl_), capacity_ / group_width);
+    slot_traits::deallocate(slot_alloc_, slots_, capacity_);
+  }
+
+  void destroy_all_() {
+    for (size_t i = 0; i < capacity_; i++) {
+      if (is_full_(ctrl_[i])) {
+        slot_traits::destroy(slot_alloc_, &slots_[i].value);
+      }
+    }
+  }
+
+  // move every entry into a new table of capacity slots
+  void rehash_(size_t capacity) {
+    auto old_ctrl = ctrl_;
+    auto old_slots = slots_;
+    auto old_capacity = capacity_;
+    allocate_(capacity);
+    for (size_t i = 0; i < old_capacity; i++) {
+      if (!is_full_(old_ctrl[i])) {
+        continue;
+      }
+      auto &slot = old_slots[i];
+      auto hash = hash_(slot.value.first);
+      auto idx = find_free_(hash);
+      ctrl_[idx] = h2_(hash);
+      // the old entry is destroyed right after, its key may be moved from
+      slot_traits::construct(slot_alloc_, &slots_[idx].value, std::move(slot.mutable_value.first),
+                             std::move(slot.value.second));
+      slot_traits::destroy(slot_alloc_, &slot.value);
+    }
+    growth_left_ -= size_;
+    if (old_capacity != 0) {
+      ctrl_traits::deallocate(ctrl_alloc_, reinterpret_cast<ctrl_group *>(old_ctrl), old_capacity / group_width);
+      slot_traits::deallocate(slot_alloc_, old_slots, old_capacity);
+    }
+  }
+
+  // the smallest capacity holding count entries
+  static size_t capacity_for_(size_t count) {
+    size_t capacity = group_width;
+    while (max_load_(capacity) < count) {
+      capacity *= 2;
+    }
+    return capacity;
+  }
+
+  void erase_slot_(size_t idx) {
+    slot_traits::destroy(slot_alloc_, &slots_[idx].value);
+    size_--;
+    // probes of other keys went on past this group only if it had no empty slot: keep a tombstone then
+    auto group_start = idx / group_width * group_width;
+    if (group(ctrl_ + group_start).match_empty() != 0) {
+      ctrl_[idx] = empty_;
+      growth_left_++;
+    } else {
+      ctrl_[idx] = deleted_;
+    }
+  }
+
+ public:
+  // constructor
+  flat_hash_map() = default;
+
+  explicit flat_hash_map(size_t capacity, const Alloc &alloc = Alloc()) : ctrl_alloc_(alloc), slot_alloc_(alloc) {
+    if (capacity > 0) {
+      allocate_(capacity_for_(capacity));
+    }
+  }
+
+  explicit flat_hash_map(const Alloc &alloc) : ctrl_alloc_(alloc), slot_alloc_(alloc) {}
+
+  flat_hash_map(std::initializer_list<kv_t> init, const Alloc &alloc = Alloc()) : flat_hash_map(init.size(), alloc) {
+    for (auto &kv : init) {
+      insert(kv);
+    }
+  }
+
+  flat_hash_map(const flat_hash_map &other)
+      : ctrl_alloc_(ctrl_traits::select_on_container_copy_construction(other.ctrl_alloc_)),
+        slot_alloc_(slot_traits::select_on_container_copy_construction(other.slot_alloc_)),
+        hash_func_(other.hash_func_) {
+    copy_from_(other);
+  }
+
+  flat_hash_map(flat_hash_map &&other) noexcept
+      : ctrl_alloc_(std::move(other.ctrl_alloc_)),
+        slot_alloc_(std::move(other.slot_alloc_)),
+        hash_func_(std::move(other.hash_func_)) {
+    steal_(other);
+  }
+
+  // destructor
+  ~flat_hash_map() {
+    destroy_all_();
+    deallocate_();
+  }
+
+  // assignment
+  flat_hash_map &operator=(const flat_hash_map &other) {
+    if (this == &other) {
+      return *this;
+    }
+    destroy_all_();
+    deallocate_();
+    if constexpr (slot_traits::propagate_on_container_copy_assignment::value) {
+      ctrl_alloc_ = other.ctrl_alloc_;
+      slot_alloc_ = other.slot_alloc_;
+    }
+    hash_func_ = other.hash_func_;
+    copy_from_(other);
+    return *this;
+  }
+
+  flat_hash_map &operator=(flat_hash_map &&other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+    destroy_all_();
+    deallocate_();
+    if constexpr (slot_traits::propagate_on_container_move_assignment::value) {
+      ctrl_alloc_ = std::move(other.ctrl_alloc_);
+      slot_alloc_ = std::move(other.slot_alloc_);
+    } else if (slot_alloc_ != other.slot_alloc_) {
+      // other's table cannot be released by our allocator, move the entries instead
+      allocate_(0);
+      size_ = 0;
+      hash_func_ = other.hash_func_;
+      reserve(other.size_);
+      for (auto itr = other.begin(); itr != other.end(); ++itr) {
+        emplace_(itr->first, std::move(itr->second));
+      }
+      other.clear();
+      return *this;
+    }
+    hash_func_ = std::move(other.hash_func_);
+    steal_(other);
+    return *this;
+  }
+
+  Alloc get_allocator() const { return Alloc(slot_alloc_); }
+
+  // iterator
+  iterator begin() { return iterator(this, next_full_(0)); }
+  iterator end() { return iterator(this, capacity_); }
+  const_iterator begin() const { return const_iterator(this, next_full_(0)); }
+  const_iterator end() const { return const_iterator(this, capacity_); }
+
+  // capacity
+  bool empty() const noexcept { return size_ == 0; }
+  size_t size() const noexcept { return size_; }
+
+  // modifier
+  void clear() noexcept {
+    destroy_all_();
+    if (capacity_ > 0) {
+      std::memset(ctrl_, empty_, capacity_);
+    }
+    size_ = 0;
+    growth_left_ = max_load_(capacity_);
+  }
+
+  std::pair<iterator, bool> insert(const kv_t &value) { return emplace_(value.first, value.second); }
+
+  // the key of value is const, it is copied
+  std::pair<iterator, bool> insert(kv_t &&value) { return emplace_(value.first, std::move(value.second)); }
+
+  void erase(iterator pos) { erase_slot_(pos.idx_); }
+
+  size_t erase(const Key &key) {
+    auto idx = get_(key, hash_(key));
+    if (idx == capacity_) {
+      return 0;
+    }
+    erase_slot_(idx);
+    return 1;
+  }
+
+  void swap(flat_hash_map &other) noexcept {
+    std::swap(ctrl_, other.ctrl_);
+    std::swap(slots_, other.slots_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+    std::swap(growth_left_, other.growth_left_);
+    std::swap(hash_func_, other.hash_func_);
+    if constexpr (slot_traits::propagate_on_container_swap::value) {
+      std::swap(ctrl_alloc_, other.ctrl_alloc_);
+      std::swap(slot_alloc_, other.slot_alloc_);
+    }
+  }
+
+  // observer
+  iterator find(const Key &key) { return iterator(this, get_(key, hash_(key))); }
+  const_iterator find(const Key &key) const { return const_iterator(this, get_(key, hash_(key))); }
+
+  T &at(const Key &key) {
+    auto idx = get_(key, hash_(key));
+    if (idx == capacity_) {
+      throw std::exception();
+    }
+    return slots_[idx].value.second;
+  }
+
+  T &operator[](const Key &key) { return emplace_(key).first->second; }
+
+  size_t count(const Key &key) const { return get_(key, hash_(key)) != capacity_ ? 1 : 0; }
+
+  // bucket API: a slot is a bucket of at most one entry
+  size_t bucket_count() const { return capacity_; }
+
+  // hash strategy
+  float load_factor() const { return capacity_ == 0 ? 0 : static_cast<float>(size_) / capacity_; }
+  float max_load_factor() const { return 0.875; }
+
+  // at least count slots, and enough for the entries
+  void rehash(size_t count) {
+    auto capacity = capacity_for_(size_);
+    while (capacity < count) {
+      capacity *= 2;
+    }
+    if (capacity != capacity_ || growth_left_ != max_load_(capacity_) - size_) {
+      rehash_(capacity);
+    }
+  }
+
+  // room for count entries without rehashing
+  void reserve(size_t count) {
+    if (count > size_ + growth_left_) {
+      rehash_(capacity_for_(count));
+    }
+  }
+
+  Hash hash_function() const { return hash_func_; }
+
+  // debug
+  void view() {
+#ifdef DEBUG
+    std::cout << "flat_hash_map => sz(" << size_ << ") cap(" << capacity_ << ")" << std::endl;
+    for (size_t g = 0; g < capacity_; g += group_width) {
+      std::cout << "\tgroup[" << g / group_width << "] : [";
+      for (auto i = g; i < g + group_width; i++) {
+        std::cout << (i == g ? "" : ", ");
+        if (is_full_(ctrl_[i])) {
+          std::cout << "(" << slots_[i].value.first << "," << slots_[i].value.second << ")";
+        } else {
+          std::cout << (ctrl_[i] == empty_ ? "_" : "x");
+        }
+      }
+      std::cout << "]" << std::endl;
+    }
+    std::cout << std::endl;
+#endif
+  }
+
+ private:
+  // insert key with a value made of args unless key is there, one lookup
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> emplace_(K &&key, Args &&...args) {
+    auto [idx, inserted] = prepare_insert_(key);
+    if (inserted) {
+      try {
+        slot_traits::construct(slot_alloc_, &slots_[idx].value, std::piecewise_construct,
+                               std::forward_as_tuple(std::forward<K>(key)),
+                               std::forward_as_tuple(std::forward<Args>(args)...));
+      } catch (...) {
+        // a tombstone is always a valid state for the slot
+        ctrl_[idx] = deleted_;
+        size_--;
+        throw;
+      }
+    }
+    return {iterator(this, idx), inserted};
+  }
+
+  // same capacity and layout as other, tombstones included
+  void copy_from_(const flat_hash_map &other) {
+    allocate_(other.capacity_);
+    if (capacity_ == 0) {
+      size_ = 0;
+      return;
+    }
+    for (size_t i = 0; i < capacity_; i++) {
+      if (is_full_(other.ctrl_[i])) {
+        slot_traits::construct(slot_alloc_, &slots_[i].value, other.slots_[i].value);
+      }
+    }
+    std::memcpy(ctrl_, other.ctrl_, capacity_);
+    size_ = other.size_;
+    growth_left_ = other.growth_left_;
+  }
+
+  // take other's table, other is left empty
+  void steal_(flat_hash_map &other) {
+    ctrl_ = other.ctrl_;
+    slots_ = other.slots_;
+    capacity_ = other.capacity_;
+    size_ = other.size_;
+    growth_left_ = other.growth_left_;
+    other.allocate_(0);
+    other.size_ = 0;
+  }
+};
+
+}  // namespace STL
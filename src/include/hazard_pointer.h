@@ -0,0 +1,187 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace STL {
+
+/**
+ * Safe memory reclamation for lock-free structures with hazard pointers (Michael, 2004).
+ *
+ * @details
+ * Before dereferencing a shared node, a thread publishes its address in one of its hazard slots (protect()).
+ * Unlinked nodes are retire()d instead of freed: each thread collects them and, once it holds enough, frees the
+ * ones no slot of any thread points to. Nodes still retired when a thread exits are handed to the next scan of
+ * another thread.
+ *
+ * Memory orders: publishing a hazard and then re-reading the source is a store followed by a load, which only a
+ * full fence keeps in order. protect()/set() and scan_ each put a seq_cst fence between their store and their loads,
+ * so either the reader sees the node unlinked (and retries) or the scan sees the hazard. Everything else is
+ * acquire/release: every store to a slot is a release, so the scan that acquires it also sees the reads made through
+ * the hazards it held before.
+ */
+class hazard_domain {
+ public:
+  static constexpr size_t slots_per_thread = 2;
+
+  // never destroyed: threads may exit (and scan) after static destruction began
+  static hazard_domain &getInstance() {
+    static auto instance = new hazard_domain();
+    return *instance;
+  }
+
+  // the slot-th hazard slot of the calling thread
+  std::atomic<void *> &slot(size_t slot) { return local_().rec_->hazards_[slot]; }
+
+  // free p with deleter(p) once no hazard slot points to it
+  void retire(void *p, void (*deleter)(void *)) {
+    auto &state = local_();
+    state.retired_.push_back({p, deleter});
+    if (state.retired_.size() >= 64 + 2 * slots_per_thread * records_.load()) {
+      scan_(state);
+    }
+  }
+
+ private:
+  struct record {
+    std::atomic<void *> hazards_[slots_per_thread] = {};
+    std::atomic<bool> active_{false};
+    record *next_{nullptr};
+  };
+
+  struct retired {
+    void *ptr_;
+    void (*deleter_)(void *);
+  };
+
+  /* the record and the retired nodes of one thread */
+  struct thread_state {
+    record *rec_;
+    std::vector<retired> retired_;
+    std::vector<void *> hazards_;  // scratch of scan_, kept to reuse its buffer
+
+    thread_state() : rec_(getInstance().acquire_()) {}
+
+    ~thread_state() {
+      auto &domain = getInstance();
+      domain.scan_(*this);
+      if (!retired_.empty()) {
+        std::lock_guard<std::mutex> lock(domain.mutex_);
+        domain.orphans_.insert(domain.orphans_.end(), retired_.begin(), retired_.end());
+      }
+      rec_->active_.store(false);
+    }
+  };
+
+  std::atomic<record *> head_{nullptr};  // every record, records are reused but never freed
+  std::atomic<size_t> records_{0};
+  std::mutex mutex_;                     // guards orphans_
+  std::vector<retired> orphans_;         // retired by threads that exited
+
+  hazard_domain() = default;
+
+  static thread_state &local_() {
+    thread_local thread_state state;
+    return state;
+  }
+
+  // reuse the record of an exited thread, or push a new one
+  record *acquire_() {
+    for (auto rec = head_.load(); rec != nullptr; rec = rec->next_) {
+      auto active = false;
+      if (rec->active_.compare_exchange_strong(active, true)) {
+        return rec;
+      }
+    }
+    auto rec = new record();
+    rec->active_.store(true);
+    rec->next_ = head_.load();
+    while (!head_.compare_exchange_weak(rec->next_, rec)) {
+    }
+    records_++;
+    return rec;
+  }
+
+  // free every node retired by state that is not hazardous, the others stay; allocates only to grow its buffers
+  void scan_(thread_state &state) {
+    auto &retired = state.retired_;
+    // the retired nodes were unlinked before this point, order that before the hazards are read (see protect())
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    {
+      // adopt the nodes of exited threads, unless another thread is at it
+      std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+      if (lock.owns_lock() && !orphans_.empty()) {
+        retired.insert(retired.end(), orphans_.begin(), orphans_.end());
+        orphans_.clear();
+      }
+    }
+    auto &hazards = state.hazards_;
+    hazards.clear();
+    for (auto rec = head_.load(); rec != nullptr; rec = rec->next_) {
+      for (auto &hazard : rec->hazards_) {
+        auto p = hazard.load(std::memory_order_acquire);
+        if (p != nullptr) {
+          hazards.push_back(p);
+        }
+      }
+    }
+    std::sort(hazards.begin(), hazards.end());
+    size_t kept = 0;
+    for (auto &r : retired) {
+      if (std::binary_search(hazards.begin(), hazards.end(), r.ptr_)) {
+        retired[kept++] = r;
+      } else {
+        r.deleter_(r.ptr_);
+      }
+    }
+    retired.resize(kept);
+  }
+};
+
+/* one hazard slot of the calling thread, cleared when the guard goes away */
+class hazard_pointer {
+ public:
+  explicit hazard_pointer(size_t slot) : slot_(hazard_domain::getInstance().slot(slot)) {}
+  hazard_pointer(const hazard_pointer &) = delete;
+  hazard_pointer &operator=(const hazard_pointer &) = delete;
+  ~hazard_pointer() { reset(); }
+
+  // load src and publish it until it is stable: the result cannot be freed before reset()
+  template <typename T>
+  T *protect(const std::atomic<T *> &src) {
+    auto p = src.load(std::memory_order_relaxed);
+    while (true) {
+      publish_(p);
+      // acquire: pairs with the release that made p reachable, its contents are visible
+      auto q = src.load(std::memory_order_acquire);
+      if (q == p) {
+        return p;
+      }
+      p = q;
+    }
+  }
+
+  // publish p, the caller checks afterwards that p is still reachable
+  template <typename T>
+  void set(T *p) {
+    publish_(const_cast<void *>(static_cast<const void *>(p)));
+  }
+
+  // release: the reads made through the hazard happen before the node is freed
+  void reset() { slot_.store(nullptr, std::memory_order_release); }
+
+ private:
+  std::atomic<void *> &slot_;
+
+  // the hazard is visible to every scan before the caller reads its source again (store-load needs a full fence);
+  // release as reset(): a scan reading the new hazard also sees the reads made through the previous one
+  void publish_(void *p) {
+    slot_.store(p, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+};
+
+}  // namespace STL
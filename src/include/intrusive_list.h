@@ -0,0 +1,308 @@
+#pragma once
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <iterator>
+#include <utility>
+
+#define DEBUG
+
+namespace STL {
+
+template <typename T, typename Hooked>
+class intrusive_list;
+
+/**
+ * The links an object embeds to be put in an intrusive_list, either as a base class or as a member.
+ * An object can unlink itself in O(1) from whatever list it is in, and does so when it is destroyed.
+ * Copying an object does not copy its links.
+ */
+class intrusive_list_hook {
+ public:
+  intrusive_list_hook() = default;
+  intrusive_list_hook(const intrusive_list_hook & /* other */) noexcept {}
+  intrusive_list_hook &operator=(const intrusive_list_hook & /* other */) noexcept { return *this; }
+  ~intrusive_list_hook() { unlink(); }
+
+  bool is_linked() const noexcept { return next_ != nullptr; }
+
+  // leave the list, no-op if not in one
+  void unlink() noexcept {
+    if (next_ == nullptr) {
+      return;
+    }
+    prev_->next_ = next_;
+    next_->prev_ = prev_;
+    prev_ = nullptr;
+    next_ = nullptr;
+  }
+
+ private:
+  template <typename T, typename Hooked>
+  friend class intrusive_list;
+
+  intrusive_list_hook *prev_{nullptr};
+  intrusive_list_hook *next_{nullptr};
+
+  // link before next
+  void link_before_(intrusive_list_hook *next) noexcept {
+    prev_ = next->prev_;
+    next_ = next;
+    prev_->next_ = this;
+    next->prev_ = this;
+  }
+};
+
+/* T derives from intrusive_list_hook */
+template <typename T>
+struct base_hook {
+  static intrusive_list_hook *to_hook(T *value) noexcept { return value; }
+  static T *from_hook(intrusive_list_hook *hook) noexcept { return static_cast<T *>(hook); }
+};
+
+/* T has an intrusive_list_hook member, e.g. member_hook<timer, &timer::hook_> */
+template <typename T, intrusive_list_hook T::*Member>
+struct member_hook {
+  static intrusive_list_hook *to_hook(T *value) noexcept { return &(value->*Member); }
+  static T *from_hook(intrusive_list_hook *hook) noexcept {
+    return reinterpret_cast<T *>(reinterpret_cast<char *>(hook) - offset_());
+  }
+
+ private:
+  // distance from the start of T to the hook
+  static ptrdiff_t offset_() noexcept {
+    static const ptrdiff_t offset = [] {
+      alignas(T) char buf[sizeof(T)];
+      auto value = reinterpret_cast<T *>(buf);
+      return reinterpret_cast<char *>(&(value->*Member)) - buf;
+    }();
+    return offset;
+  }
+};
+
+/**
+ * A doubly linked list of objects that embed their own links (intrusive_list_hook), insertion and removal never
+ * allocate nor copy. The list does not own the objects: they must outlive their membership, or unlink themselves
+ * (their hook does so on destruction).
+ *
+ * @details
+ * <ul>
+ * <li>Objects derived from intrusive_list_hook: intrusive_list<T>; with hook members, one per list the object can be
+ * in at the same time: intrusive_list<T, member_hook<T, &T::hook_>>.</li>
+ * <li>Since objects may leave on their own, size() walks the list: O(n). empty() is O(1).</li>
+ * </ul>
+ */
+template <typename T, typename Hooked = base_hook<T>>
+class intrusive_list {
+ public:
+  class Iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T *;
+    using reference = T &;
+
+    intrusive_list_hook *hook_{nullptr};
+
+   public:
+    Iterator() = default;
+    explicit Iterator(intrusive_list_hook *hook) : hook_(hook) {}
+
+    T &operator*() const { return *Hooked::from_hook(hook_); }
+    T *operator->() const { return Hooked::from_hook(hook_); }
+    // ++itr
+    Iterator &operator++() {
+      hook_ = hook_->next_;
+      return *this;
+    }
+    // itr++
+    Iterator operator++(int) {
+      auto old = *this;
+      hook_ = hook_->next_;
+      return old;
+    }
+    // --itr
+    Iterator &operator--() {
+      hook_ = hook_->prev_;
+      return *this;
+    }
+    // itr--
+    Iterator operator--(int) {
+      auto old = *this;
+      hook_ = hook_->prev_;
+      return old;
+    }
+
+    bool operator==(const Iterator &other) const { return hook_ == other.hook_; }
+    bool operator!=(const Iterator &other) const { return hook_ != other.hook_; }
+  };
+
+  using iterator = Iterator;
+  using const_iterator = const Iterator;
+  using value_type = T;
+
+ private:
+  intrusive_list_hook sentinel_;  // circular: its next_ is the head, its prev_ the tail
+
+  intrusive_list_hook *end_() const { return const_cast<intrusive_list_hook *>(&sentinel_); }
+
+  void init_() noexcept {
+    sentinel_.next_ = end_();
+    sentinel_.prev_ = end_();
+  }
+
+  // take other's objects, other is left empty
+  void steal_(intrusive_list &other) noexcept {
+    if (other.empty()) {
+      init_();
+      return;
+    }
+    sentinel_.next_ = other.sentinel_.next_;
+    sentinel_.prev_ = other.sentinel_.prev_;
+    sentinel_.next_->prev_ = end_();
+    sentinel_.prev_->next_ = end_();
+    other.init_();
+  }
+
+  static intrusive_list_hook *hook_of_(T &value) {
+    auto hook = Hooked::to_hook(&value);
+    if (hook->is_linked()) {
+      // already in a list: splice it, or unlink it first
+      throw std::exception();
+    }
+    return hook;
+  }
+
+ public:
+  // constructor
+  intrusive_list() noexcept { init_(); }
+
+  intrusive_list(const intrusive_list &) = delete;
+  intrusive_list &operator=(const intrusive_list &) = delete;
+
+  intrusive_list(intrusive_list &&other) noexcept { steal_(other); }
+
+  intrusive_list &operator=(intrusive_list &&other) noexcept {
+    if (this != &other) {
+      clear();
+      steal_(other);
+    }
+    return *this;
+  }
+
+  // destructor: the objects are left unlinked
+  ~intrusive_list() { clear(); }
+
+  // iterator
+  iterator begin() { return Iterator(sentinel_.next_); }
+  iterator end() { return Iterator(end_()); }
+  const_iterator begin() const { return Iterator(sentinel_.next_); }
+  const_iterator end() const { return Iterator(end_()); }
+
+  // the iterator of an object in this list, O(1)
+  iterator iterator_to(T &value) { return Iterator(Hooked::to_hook(&value)); }
+
+  // capacity
+  bool empty() const noexcept { return sentinel_.next_ == end_(); }
+  size_t size() const noexcept {
+    size_t size = 0;
+    for (auto hook = sentinel_.next_; hook != end_(); hook = hook->next_) {
+      size++;
+    }
+    return size;
+  }
+
+  T &front() { return *begin(); }
+  T &back() { return *Iterator(sentinel_.prev_); }
+
+  // modifier, value must not be in a list already
+  void push_back(T &value) { hook_of_(value)->link_before_(end_()); }
+  void push_front(T &value) { hook_of_(value)->link_before_(sentinel_.next_); }
+
+  void pop_back() {
+    if (empty()) {
+      throw std::exception();
+    }
+    sentinel_.prev_->unlink();
+  }
+
+  void pop_front() {
+    if (empty()) {
+      throw std::exception();
+    }
+    sentinel_.next_->unlink();
+  }
+
+  // returns the iterator to value
+  iterator insert(iterator pos, T &value) {
+    auto hook = hook_of_(value);
+    hook->link_before_(pos.hook_);
+    return Iterator(hook);
+  }
+
+  // unlink the object at pos, returns the iterator following it
+  iterator erase(iterator pos) {
+    auto next = pos.hook_->next_;
+    pos.hook_->unlink();
+    return Iterator(next);
+  }
+
+  // unlink value from the list it is in, O(1) without the list itself
+  static void remove(T &value) noexcept { Hooked::to_hook(&value)->unlink(); }
+
+  // unlink every object
+  void clear() noexcept {
+    auto hook = sentinel_.next_;
+    while (hook != end_()) {
+      auto next = hook->next_;
+      hook->prev_ = nullptr;
+      hook->next_ = nullptr;
+      hook = next;
+    }
+    init_();
+  }
+
+  // move value, from whatever list it is in, before pos
+  void splice(iterator pos, T &value) noexcept {
+    auto hook = Hooked::to_hook(&value);
+    if (hook == pos.hook_) {
+      return;
+    }
+    hook->unlink();
+    hook->link_before_(pos.hook_);
+  }
+
+  // move every object of other before pos, O(1)
+  void splice(iterator pos, intrusive_list &other) noexcept {
+    if (this == &other || other.empty()) {
+      return;
+    }
+    auto first = other.sentinel_.next_;
+    auto last = other.sentinel_.prev_;
+    other.init_();
+    auto prev = pos.hook_->prev_;
+    prev->next_ = first;
+    first->prev_ = prev;
+    last->next_ = pos.hook_;
+    pos.hook_->prev_ = last;
+  }
+
+  void swap(intrusive_list &other) noexcept {
+    auto tmp = intrusive_list(std::move(other));
+    other.steal_(*this);
+    steal_(tmp);
+  }
+
+  void view() {
+#ifdef DEBUG
+    std::cout << "intrusive_list => [";
+    for (auto itr = begin(); itr != end(); itr++) {
+      std::cout << (itr == begin() ? "" : ",") << *itr;
+    }
+    std::cout << "]" << std::endl;
+#endif
+  }
+};
+
+}  // namespace STL
@@ -1,41 +1,52 @@
 #pragma once
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include "arena.h"
+#include "pool_allocator.h"
 #include "shared_ptr.h"
 
 #define DEBUG
 
 namespace STL {
 
-template <typename T>
+template <typename T, typename Alloc = std::allocator<T>>
 class list {
  public:
-  struct node {
-    T val_{};
-    node *prev_{nullptr};
-    node *next_{nullptr};
-
-    explicit node() = default;
+  // links only: the sentinel is one of these and needs no T
+  struct node_base {
+    node_base *prev_{nullptr};
+    node_base *next_{nullptr};
+  };
 
-    explicit node(T val) : val_(val) {}
+  struct node : node_base {
+    T val_;
 
-    node(const node &other) {
-      val_ = other.val_;
-      prev_ = other.prev_;
-      next_ = other.next_;
-    }
+    // construct the value in place
+    template <typename... Args>
+    explicit node(Args &&...args) : val_(std::forward<Args>(args)...) {}
   };
 
   class Iterator {
    public:
-    node *node_{nullptr};
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T *;
+    using reference = T &;
+
+    node_base *node_{nullptr};
 
    public:
     Iterator() = default;
-    explicit Iterator(node &node) : node_(&node){};
-    explicit Iterator(node *node) : node_(node){};
+    explicit Iterator(node_base &node) : node_(&node){};
+    explicit Iterator(node_base *node) : node_(node){};
     ~Iterator() = default;
 
-    T &operator*() { return node_->val_; }
-    T *operator->() { return &(node_->val_); }
+    T &operator*() { return static_cast<node *>(node_)->val_; }
+    T *operator->() { return &(static_cast<node *>(node_)->val_); }
     // ++itr
     Iterator operator++() {
       node_ = node_->next_;
@@ -72,140 +83,418 @@ class list {
 
   using iterator = Iterator;
   using const_iterator = const Iterator;
+  using allocator_type = Alloc;
 
  private:
-  // double list with dummy tail and head
-  node *head_{};
-  node *tail_{};
+  using node_alloc_t = typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+  using node_traits = std::allocator_traits<node_alloc_t>;
+
+  node_alloc_t alloc_{};  // where nodes come from
+  // circular double list through a dummy node embedded in the list: its next_ is the head, its prev_ the tail
+  node_base sentinel_;
   size_t size_{0};
 
+  node_base *end_() const { return const_cast<node_base *>(&sentinel_); }
+  static T &value_(node_base *node) { return static_cast<struct node *>(node)->val_; }
+
+  template <typename... Args>
+  node *new_node_(Args &&...args) {
+    auto node = node_traits::allocate(alloc_, 1);
+    ::new (static_cast<void *>(node)) struct node(std::forward<Args>(args)...);
+    return node;
+  }
+
+  void delete_node_(node_base *base) {
+    auto node = static_cast<struct node *>(base);
+    node->~node();
+    node_traits::deallocate(alloc_, node, 1);
+  }
+
+  // destroy and release every node in one sweep, without relinking: the list must be reset or dropped afterwards
+  void free_() {
+    if constexpr (std::is_trivially_destructible_v<node> && is_noop_deallocate_v<node_alloc_t>) {
+      // nothing to run nor give back: the nodes die with their arena
+      return;
+    }
+    auto curr = sentinel_.next_;
+    while (curr != end_()) {
+      auto next = curr->next_;
+      delete_node_(curr);
+      curr = next;
+    }
+  }
+
   void init_() {
-    head_ = new node();
-    tail_ = new node();
-    head_->next_ = tail_;
-    head_->prev_ = tail_;
-    tail_->next_ = head_;
-    tail_->prev_ = head_;
+    sentinel_.next_ = end_();
+    sentinel_.prev_ = end_();
   }
 
-  // insert before next
-  void insert_(const T &val, node *next) {
-    auto node = new struct node(val);
+  // point the ends of the chain back at our sentinel, after it was copied from another list
+  void relink_() {
+    if (size_ == 0) {
+      init_();
+      return;
+    }
+    sentinel_.next_->prev_ = end_();
+    sentinel_.prev_->next_ = end_();
+  }
+
+  // take other's nodes, other is left empty
+  void steal_(list &other) {
+    sentinel_.next_ = other.sentinel_.next_;
+    sentinel_.prev_ = other.sentinel_.prev_;
+    size_ = other.size_;
+    relink_();
+    other.init_();
+    other.size_ = 0;
+  }
+
+  // construct a node from args before next
+  template <typename... Args>
+  node *emplace_(node_base *next, Args &&...args) {
+    auto node = new_node_(std::forward<Args>(args)...);
     auto prev = next->prev_;
     node->next_ = next;
     node->prev_ = prev;
     prev->next_ = node;
     next->prev_ = node;
     size_++;
+    return node;
   }
 
-  void remove_(node *node) {
+  void remove_(node_base *node) {
     auto prev = node->prev_;
     auto next = node->next_;
 
     prev->next_ = next;
     next->prev_ = prev;
-    delete node;
+    delete_node_(node);
     size_--;
   }
 
+  // move the chain [first, last] (last included) before pos, pos must not be inside the chain
+  static void transfer_(node_base *pos, node_base *first, node_base *last) {
+    first->prev_->next_ = last->next_;
+    last->next_->prev_ = first->prev_;
+
+    auto prev = pos->prev_;
+    prev->next_ = first;
+    first->prev_ = prev;
+    last->next_ = pos;
+    pos->prev_ = last;
+  }
+
+  // nodes can only change hands if other's allocator can release them
+  void check_splice_(const list &other) const {
+    if constexpr (!node_traits::is_always_equal::value) {
+      if (alloc_ != other.alloc_) {
+        throw std::exception();
+      }
+    }
+  }
+
+  // stable merge of two null-terminated chains linked by next_ only
+  template <typename Compare>
+  static node_base *merge_chains_(node_base *a, node_base *b, Compare &comp) {
+    node_base *head = nullptr;
+    node_base **tail = &head;
+    while (a != nullptr && b != nullptr) {
+      // take from a on ties: a holds the earlier elements
+      if (comp(value_(b), value_(a))) {
+        *tail = b;
+        b = b->next_;
+      } else {
+        *tail = a;
+        a = a->next_;
+      }
+      tail = &(*tail)->next_;
+    }
+    *tail = a != nullptr ? a : b;
+    return head;
+  }
+
  public:
   // constructor
   list() { init_(); }
 
-  list(std::initializer_list<T> init) {
+  explicit list(const Alloc &alloc) : alloc_(alloc) { init_(); }
+
+  list(std::initializer_list<T> init, const Alloc &alloc = Alloc()) : alloc_(alloc) {
     init_();
     for (auto itr = init.begin(); itr != init.end(); itr++) {
-      insert_(*itr, tail_);
+      emplace_(end_(), *itr);
     }
   }
 
-  list(const list<T> &other) {
+  list(const list<T, Alloc> &other) : alloc_(node_traits::select_on_container_copy_construction(other.alloc_)) {
     init_();
     for (auto itr = other.begin(); itr != other.end(); itr++) {
-      insert_(*itr, tail_);
+      emplace_(end_(), *itr);
     }
   }
 
-  list(list<T> &&other) noexcept {
-    head_ = other.head_;
-    tail_ = other.tail_;
-    size_ = other.size_;
-
-    other.init_();
-  }
+  list(list<T, Alloc> &&other) noexcept : alloc_(std::move(other.alloc_)) { steal_(other); }
 
   // destructor
-  ~list() {
-    for (auto curr = head_; curr != tail_; curr = curr->next_) {
-      delete curr;
+  ~list() { free_(); }
+
+  constexpr list<T, Alloc> &operator=(const list<T, Alloc> &other) {
+    if (this == &other) {
+      return *this;
+    }
+    if constexpr (node_traits::propagate_on_container_copy_assignment::value) {
+      if (alloc_ != other.alloc_) {
+        // nodes must go back to the allocator they came from
+        clear();
+        alloc_ = other.alloc_;
+      }
     }
-    delete tail_;
+    clear();
+    for (auto itr = other.begin(); itr != other.end(); itr++) {
+      emplace_(end_(), *itr);
+    }
+    return *this;
   }
 
-  constexpr list<T> &operator=(const list<T> &other) {
+  list<T, Alloc> &operator=(list<T, Alloc> &&other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
     clear();
-    for (auto itr = other.begin(); itr != other.end(); itr++) {
-      insert_(*itr, tail_);
+    if constexpr (node_traits::propagate_on_container_move_assignment::value) {
+      std::swap(alloc_, other.alloc_);
+    } else if (alloc_ != other.alloc_) {
+      // other's nodes cannot be released by alloc_, move the elements instead
+      for (auto itr = other.begin(); itr != other.end(); itr++) {
+        emplace_(end_(), std::move(*itr));
+      }
+      other.clear();
+      return *this;
     }
+    steal_(other);
     return *this;
   }
 
+  Alloc get_allocator() const { return Alloc(alloc_); }
+
   // iterator
-  iterator begin() { return Iterator(head_->next_); }
-  iterator end() { return Iterator(tail_); }
-  const_iterator begin() const { return Iterator(head_->next_); }
-  const_iterator end() const { return Iterator(tail_); }
+  iterator begin() { return Iterator(sentinel_.next_); }
+  iterator end() { return Iterator(end_()); }
+  const_iterator begin() const { return Iterator(sentinel_.next_); }
+  const_iterator end() const { return Iterator(end_()); }
 
   // capacity
   bool empty() { return size_ == 0; }
   size_t size() const { return size_; }
 
   // modifier
-  void push_back(const T &value) { insert_(value, tail_); }
+  void push_back(const T &value) { emplace_(end_(), value); }
+  void push_back(T &&value) { emplace_(end_(), std::move(value)); }
+
+  template <typename... Args>
+  T &emplace_back(Args &&...args) {
+    return emplace_(end_(), std::forward<Args>(args)...)->val_;
+  }
 
   void pop_back() {
     if (size_ == 0) {
       throw std::exception();
     }
-    remove_(tail_->prev_);
+    remove_(sentinel_.prev_);
   }
 
-  void push_front(const T &value) { insert_(value, head_->next_); }
+  void push_front(const T &value) { emplace_(sentinel_.next_, value); }
+  void push_front(T &&value) { emplace_(sentinel_.next_, std::move(value)); }
+
+  template <typename... Args>
+  T &emplace_front(Args &&...args) {
+    return emplace_(sentinel_.next_, std::forward<Args>(args)...)->val_;
+  }
 
   void pop_front() {
     if (size_ == 0) {
       throw std::exception();
     }
-    remove_(head_->next_);
+    remove_(sentinel_.next_);
   }
 
   void clear() {
-    for (node *curr = head_->next_; curr != tail_; curr = curr->next_) {
-      remove_(curr);
-    }
+    free_();
+    init_();
+    size_ = 0;
   }
 
   void erase(iterator pos) { remove_(pos.node_); }
 
-  void insert(iterator pos, const T &value) { insert_(value, pos.node_); }
+  iterator insert(iterator pos, const T &value) { return Iterator(emplace_(pos.node_, value)); }
+  iterator insert(iterator pos, T &&value) { return Iterator(emplace_(pos.node_, std::move(value))); }
 
-  void swap(list &other) {
-    auto tmp_size = size_;
-    auto tmp_head = head_;
-    auto tmp_tail = tail_;
+  // construct the value in a new node before pos
+  template <typename... Args>
+  iterator emplace(iterator pos, Args &&...args) {
+    return Iterator(emplace_(pos.node_, std::forward<Args>(args)...));
+  }
 
-    size_ = other.size_;
-    head_ = other.head_;
-    tail_ = other.tail_;
+  // move all nodes of other before pos, O(1)
+  void splice(iterator pos, list &other) {
+    if (this == &other || other.size_ == 0) {
+      return;
+    }
+    check_splice_(other);
+    transfer_(pos.node_, other.sentinel_.next_, other.sentinel_.prev_);
+    size_ += other.size_;
+    other.size_ = 0;
+  }
+
+  void splice(iterator pos, list &&other) { splice(pos, other); }
+
+  // move the node at itr of other before pos, O(1)
+  void splice(iterator pos, list &other, iterator itr) {
+    if (pos.node_ == itr.node_ || pos.node_ == itr.node_->next_) {
+      return;
+    }
+    check_splice_(other);
+    transfer_(pos.node_, itr.node_, itr.node_);
+    if (this != &other) {
+      size_++;
+      other.size_--;
+    }
+  }
+
+  // move [first, last) of other before pos, O(1) within a list, otherwise O(last - first) to count the nodes
+  void splice(iterator pos, list &other, iterator first, iterator last) {
+    auto size = this == &other ? 0 : static_cast<size_t>(std::distance(first, last));
+    splice(pos, other, first, last, size);
+  }
+
+  // move [first, last) of other before pos, size is last - first and is trusted: O(1)
+  void splice(iterator pos, list &other, iterator first, iterator last, size_t size) {
+    if (first == last) {
+      return;
+    }
+    check_splice_(other);
+    transfer_(pos.node_, first.node_, last.node_->prev_);
+    if (this != &other) {
+      size_ += size;
+      other.size_ -= size;
+    }
+  }
+
+  // merge sorted other into this sorted list, stable and without copying any value, other is left empty
+  void merge(list &other) { merge(other, std::less<>()); }
+
+  template <typename Compare>
+  void merge(list &other, Compare comp) {
+    if (this == &other || other.size_ == 0) {
+      return;
+    }
+    check_splice_(other);
+    auto curr = sentinel_.next_;
+    auto from = other.sentinel_.next_;
+    while (curr != end_() && from != other.end_()) {
+      if (comp(value_(from), value_(curr))) {
+        auto next = from->next_;
+        transfer_(curr, from, from);
+        from = next;
+      } else {
+        curr = curr->next_;
+      }
+    }
+    if (from != other.end_()) {
+      transfer_(end_(), from, other.sentinel_.prev_);
+    }
+    size_ += other.size_;
+    other.size_ = 0;
+  }
+
+  void merge(list &&other) { merge(other); }
+
+  // stable bottom-up merge sort, O(n log n), nodes are relinked and values never copied
+  void sort() { sort(std::less<>()); }
+
+  template <typename Compare>
+  void sort(Compare comp) {
+    if (size_ < 2) {
+      return;
+    }
+    // bins[i] is a sorted chain of 2^i nodes (or empty), the higher the bin the earlier its nodes
+    node_base *bins[64] = {};
+    sentinel_.prev_->next_ = nullptr;
+    auto rest = sentinel_.next_;
+    while (rest != nullptr) {
+      auto carry = rest;
+      rest = rest->next_;
+      carry->next_ = nullptr;
+      size_t i = 0;
+      for (; i < 63 && bins[i] != nullptr; i++) {
+        carry = merge_chains_(bins[i], carry, comp);
+        bins[i] = nullptr;
+      }
+      bins[i] = carry;
+    }
+    node_base *sorted = nullptr;
+    for (auto bin : bins) {
+      if (bin != nullptr) {
+        sorted = merge_chains_(bin, sorted, comp);
+      }
+    }
+    // restore prev_ links
+    auto prev = end_();
+    for (auto curr = sorted; curr != nullptr; curr = curr->next_) {
+      curr->prev_ = prev;
+      prev->next_ = curr;
+      prev = curr;
+    }
+    prev->next_ = end_();
+    sentinel_.prev_ = prev;
+  }
 
-    other.size_ = tmp_size;
-    other.head_ = tmp_head;
-    other.tail_ = tmp_tail;
+  void reverse() noexcept {
+    auto curr = end_();
+    do {
+      std::swap(curr->prev_, curr->next_);
+      curr = curr->prev_;
+    } while (curr != end_());
+  }
+
+  // erase every element equal to its predecessor, returns the number of erased elements
+  size_t unique() { return unique(std::equal_to<>()); }
+
+  template <typename BinaryPredicate>
+  size_t unique(BinaryPredicate pred) {
+    size_t removed = 0;
+    if (size_ == 0) {
+      return removed;
+    }
+    auto prev = sentinel_.next_;
+    auto curr = prev->next_;
+    while (curr != end_()) {
+      auto next = curr->next_;
+      if (pred(value_(prev), value_(curr))) {
+        remove_(curr);
+        removed++;
+      } else {
+        prev = curr;
+      }
+      curr = next;
+    }
+    return removed;
+  }
+
+  void swap(list &other) {
+    std::swap(sentinel_.next_, other.sentinel_.next_);
+    std::swap(sentinel_.prev_, other.sentinel_.prev_);
+    std::swap(size_, other.size_);
+    relink_();
+    other.relink_();
+
+    if constexpr (node_traits::propagate_on_container_swap::value) {
+      std::swap(alloc_, other.alloc_);
+    }
   }
 
   // operator
-  bool operator==(const list<T> &other) {
+  bool operator==(const list<T, Alloc> &other) {
     if (size() != other.size()) {
       return false;
     }
@@ -235,4 +524,8 @@ class list {
   }
 };
 
+/* a list whose nodes come from node_pool: cheaper churn, but the pool keeps its peak size for the whole program */
+template <typename T>
+using pooled_list = list<T, pool_allocator<T>>;
+
 }  // namespace STL
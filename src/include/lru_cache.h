@@ -0,0 +1,226 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <utility>
+#include "list.h"
+#include "pool_allocator.h"
+#include "unordered_map.h"
+
+#define DEBUG
+
+namespace STL {
+
+/* every entry weighs 1: the capacity of the cache is a number of entries */
+struct unit_weigher {
+  template <typename Key, typename Value>
+  size_t operator()(const Key & /* key */, const Value & /* value */) const {
+    return 1;
+  }
+};
+
+/**
+ * Least recently used cache: a list of entries from the most to the least recently used, indexed by an
+ * unordered_map from key to list node. get, put, touch and evict are O(1).
+ *
+ * @details
+ * <ul>
+ * <li>The capacity bounds the total weight of the entries, weigher(key, value) being the weight of one (1 by default,
+ * or e.g. its size in bytes).</li>
+ * <li>put evicts from the least recently used end until the new entry fits, and recycles the last evicted node:
+ * key and value are assigned in place (reusing e.g. the buffer of a string), and every other node comes from and goes
+ * back to the pool of list, so a full cache does not allocate.</li>
+ * <li>hits/misses count get, evictions count the entries dropped to make room.</li>
+ * </ul>
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>, typename Weigher = unit_weigher>
+class lru_cache {
+ private:
+  struct entry {
+    Key key_;
+    Value value_;
+    size_t weight_;
+
+    template <typename K, typename V>
+    entry(K &&key, V &&value, size_t weight)
+        : key_(std::forward<K>(key)), value_(std::forward<V>(value)), weight_(weight) {}
+  };
+
+  using entry_list = pooled_list<entry>;
+  using entry_itr = typename entry_list::iterator;
+  using index_t = unordered_map<Key, entry_itr, Hash, pool_allocator<std::pair<const Key, entry_itr>>>;
+
+  entry_list entries_;  // most recently used first
+  index_t index_;       // key => its node in entries_
+  size_t capacity_;     // max total weight
+  size_t weight_{0};    // total weight of the entries
+  Weigher weigher_;
+
+  size_t hits_{0};
+  size_t misses_{0};
+  size_t evictions_{0};
+
+  // the node of key moved to the front, or end() if key is absent
+  entry_itr promote_(const Key &key) {
+    auto pos = index_.find(key);
+    if (pos == index_.end()) {
+      return entries_.end();
+    }
+    auto itr = pos->second;
+    entries_.splice(entries_.begin(), entries_, itr);
+    return itr;
+  }
+
+  // unindex the least recently used entry, its node is left in place
+  entry_itr unindex_back_() {
+    auto itr = --entries_.end();
+    index_.erase(index_.find(itr->key_));
+    weight_ -= itr->weight_;
+    evictions_++;
+    return itr;
+  }
+
+  // evict the least recently used entries until the capacity is respected
+  void trim_() {
+    while (weight_ > capacity_) {
+      entries_.erase(unindex_back_());
+    }
+  }
+
+  // see put
+  template <typename V>
+  bool put_(const Key &key, V &&value) {
+    auto weight = weigher_(key, value);
+    if (weight > capacity_) {
+      erase(key);
+      return false;
+    }
+    auto itr = promote_(key);
+    if (itr != entries_.end()) {
+      itr->value_ = std::forward<V>(value);
+      weight_ = weight_ - itr->weight_ + weight;
+      itr->weight_ = weight;
+      // itr is at the front and fits alone: it is never reached
+      trim_();
+      return true;
+    }
+
+    // make room, the last evicted node is moved to the front to hold the new entry
+    auto recycled = entries_.end();
+    while (weight_ + weight > capacity_) {
+      if (recycled != entries_.end()) {
+        entries_.erase(recycled);
+      }
+      recycled = unindex_back_();
+      entries_.splice(entries_.begin(), entries_, recycled);
+    }
+    if (recycled == entries_.end()) {
+      entries_.emplace_front(key, std::forward<V>(value), weight);
+    } else {
+      recycled->key_ = key;
+      recycled->value_ = std::forward<V>(value);
+      recycled->weight_ = weight;
+    }
+    index_.insert({key, entries_.begin()});
+    weight_ += weight;
+    return true;
+  }
+
+ public:
+  // capacity: the max total weight, the max number of entries by default
+  explicit lru_cache(size_t capacity, Weigher weigher = Weigher()) : capacity_(capacity), weigher_(weigher) {}
+
+  lru_cache(const lru_cache &) = delete;
+  lru_cache &operator=(const lru_cache &) = delete;
+
+  // the value of key, marked most recently used; nullptr on a miss. Valid until the entry is evicted or erased
+  Value *get(const Key &key) {
+    auto itr = promote_(key);
+    if (itr == entries_.end()) {
+      misses_++;
+      return nullptr;
+    }
+    hits_++;
+    return &itr->value_;
+  }
+
+  // the value of key, without marking it nor counting a hit or miss
+  Value *peek(const Key &key) {
+    auto pos = index_.find(key);
+    return pos == index_.end() ? nullptr : &pos->second->value_;
+  }
+
+  // mark key most recently used, false if it is absent
+  bool touch(const Key &key) { return promote_(key) != entries_.end(); }
+
+  bool contains(const Key &key) { return index_.count(key) > 0; }
+
+  /**
+   * Insert or assign key, as the most recently used entry, evicting the least recently used ones to make room.
+   * Returns false if the entry alone outweighs the capacity: it is not cached (and an older value of key is dropped).
+   */
+  bool put(const Key &key, const Value &value) { return put_(key, value); }
+  bool put(const Key &key, Value &&value) { return put_(key, std::move(value)); }
+
+  // drop the least recently used entry, false if the cache is empty
+  bool evict() {
+    if (entries_.empty()) {
+      return false;
+    }
+    entries_.erase(unindex_back_());
+    return true;
+  }
+
+  // false if key is absent
+  bool erase(const Key &key) {
+    auto pos = index_.find(key);
+    if (pos == index_.end()) {
+      return false;
+    }
+    auto itr = pos->second;
+    index_.erase(pos);
+    weight_ -= itr->weight_;
+    entries_.erase(itr);
+    return true;
+  }
+
+  void clear() {
+    index_.clear();
+    entries_.clear();
+    weight_ = 0;
+  }
+
+  // evicts the least recently used entries until the cache fits
+  void set_capacity(size_t capacity) {
+    capacity_ = capacity;
+    trim_();
+  }
+
+  // capacity
+  bool empty() const { return entries_.size() == 0; }
+  size_t size() const { return entries_.size(); }
+  size_t weight() const { return weight_; }
+  size_t capacity() const { return capacity_; }
+
+  // statistics
+  size_t hits() const { return hits_; }
+  size_t misses() const { return misses_; }
+  size_t evictions() const { return evictions_; }
+  void reset_stats() {
+    hits_ = 0;
+    misses_ = 0;
+    evictions_ = 0;
+  }
+
+  void view() {
+#ifdef DEBUG
+    std::cout << "lru_cache => sz(" << size() << ") weight(" << weight_ << "/" << capacity_ << ") : [";
+    for (auto itr = entries_.begin(); itr != entries_.end(); itr++) {
+      std::cout << (itr == entries_.begin() ? "" : ",") << "(" << itr->key_ << "," << itr->value_ << ")";
+    }
+    std::cout << "]" << std::endl;
+#endif
+  }
+};
+
+}  // namespace STL
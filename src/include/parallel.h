@@ -0,0 +1,244 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "simd.h"
+
+/**
+ * Bulk operations over large arrays split across a thread pool: uninitialized_fill_n, uninitialized_copy,
+ * uninitialized_value_construct_n, equal.
+ *
+ * @details
+ * <ul>
+ * <li>Ranges smaller than threshold() bytes run on the calling thread, as do element types whose construction may
+ * throw and sources that are not random access; constructions are thus all or nothing. An exception thrown by a
+ * comparison in a chunk is rethrown on the calling thread.</li>
+ * <li>Chunking is deterministic: a range of n elements is cut into k = min(max_chunks(), n) chunks and chunk i is
+ * [i * n / k, (i + 1) * n / k), whichever thread ends up running it.</li>
+ * <li>The pool holds hardware_concurrency - 1 workers, started on first use; the calling thread runs chunks too, so
+ * nested calls cannot deadlock.</li>
+ * </ul>
+ */
+namespace STL::parallel {
+
+inline std::atomic<size_t> &threshold_() {
+  static std::atomic<size_t> threshold{16 * 1024 * 1024};
+  return threshold;
+}
+
+inline std::atomic<size_t> &max_chunks_() {
+  static std::atomic<size_t> max_chunks{std::max<size_t>(1, std::thread::hardware_concurrency())};
+  return max_chunks;
+}
+
+// ranges of at least threshold() bytes are split, SIZE_MAX turns splitting off
+inline size_t threshold() { return threshold_().load(std::memory_order_relaxed); }
+inline void set_threshold(size_t bytes) { threshold_().store(bytes, std::memory_order_relaxed); }
+
+// number of chunks a split range is cut into, defaults to the number of hardware threads
+inline size_t max_chunks() { return max_chunks_().load(std::memory_order_relaxed); }
+inline void set_max_chunks(size_t chunks) {
+  max_chunks_().store(std::max<size_t>(1, chunks), std::memory_order_relaxed);
+}
+
+/* a fixed set of workers running indexed tasks, tasks must not throw */
+class thread_pool {
+ public:
+  static thread_pool &getInstance() {
+    static thread_pool instance(std::max<size_t>(1, std::thread::hardware_concurrency()) - 1);
+    return instance;
+  }
+
+  explicit thread_pool(size_t workers) {
+    for (size_t i = 0; i < workers; i++) {
+      workers_.emplace_back([this] { loop_(); });
+    }
+  }
+
+  thread_pool(const thread_pool &) = delete;
+  void operator=(const thread_pool &) = delete;
+
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto &worker : workers_) {
+      worker.join();
+    }
+  }
+
+  size_t size() const noexcept { return workers_.size(); }
+
+  // task(i) for every i in [0, count), returns once all of them are done
+  template <typename F>
+  void run(size_t count, F &&task) {
+    auto j = job();
+    j.fn_ = [](void *ctx, size_t i) { (*static_cast<std::remove_reference_t<F> *>(ctx))(i); };
+    j.ctx_ = const_cast<void *>(static_cast<const void *>(std::addressof(task)));
+    j.count_ = count;
+    if (workers_.empty() || count <= 1) {
+      work_(j);
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      jobs_.push_back(&j);
+    }
+    work_cv_.notify_all();
+    work_(j);
+    // every index is claimed, wait for the workers still running one
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto itr = std::find(jobs_.begin(), jobs_.end(), &j);
+    if (itr != jobs_.end()) {
+      jobs_.erase(itr);
+    }
+    done_cv_.wait(lock, [&] { return j.active_ == 0; });
+  }
+
+ private:
+  struct job {
+    void (*fn_)(void *ctx, size_t i){nullptr};
+    void *ctx_{nullptr};
+    size_t count_{0};
+    std::atomic<size_t> next_{0};  // next index to claim
+    size_t active_{0};             // workers inside the job, guarded by mutex_
+  };
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable work_cv_;  // a job was queued or the pool stops
+  std::condition_variable done_cv_;  // a worker left a job
+  std::deque<job *> jobs_;           // jobs with indices left to claim
+  bool stop_{false};
+
+  static void work_(job &j) {
+    for (auto i = j.next_.fetch_add(1); i < j.count_; i = j.next_.fetch_add(1)) {
+      j.fn_(j.ctx_, i);
+    }
+  }
+
+  void loop_() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      work_cv_.wait(lock, [&] { return stop_ || !jobs_.empty(); });
+      if (stop_) {
+        return;
+      }
+      auto j = jobs_.front();
+      if (j->next_.load() >= j->count_) {
+        // nothing left to claim, the owner waits for the workers inside
+        jobs_.pop_front();
+        continue;
+      }
+      j->active_++;
+      lock.unlock();
+      work_(*j);
+      lock.lock();
+      if (--j->active_ == 0) {
+        done_cv_.notify_all();
+      }
+    }
+  }
+};
+
+// number of chunks n elements of elem_size bytes are cut into
+inline size_t chunks(size_t n, size_t elem_size) {
+  if (n == 0 || n * elem_size < threshold()) {
+    return 1;
+  }
+  return std::min(max_chunks(), n);
+}
+
+// fn(first, last) on every chunk of [0, n)
+template <typename F>
+void for_each_chunk(size_t n, size_t elem_size, F &&fn) {
+  auto k = chunks(n, elem_size);
+  if (k == 1) {
+    fn(size_t(0), n);
+    return;
+  }
+  thread_pool::getInstance().run(k, [&](size_t i) { fn(i * n / k, (i + 1) * n / k); });
+}
+
+/* ------------------------------------------- algorithms ------------------------------------------- */
+
+// construct dst[0, n) as copies of value
+template <typename T>
+void uninitialized_fill_n(T *dst, size_t n, const T &value) {
+  if constexpr (std::is_nothrow_copy_constructible_v<T>) {
+    for_each_chunk(n, sizeof(T), [&](size_t first, size_t last) {
+      std::uninitialized_fill_n(dst + first, last - first, value);
+    });
+  } else {
+    std::uninitialized_fill_n(dst, n, value);
+  }
+}
+
+// construct dst[0, n) as copies of the n elements from src on
+template <typename It, typename T>
+void uninitialized_copy(It src, size_t n, T *dst) {
+  using category = typename std::iterator_traits<It>::iterator_category;
+  if constexpr (std::is_convertible_v<category, std::random_access_iterator_tag> &&
+                std::is_nothrow_constructible_v<T, decltype(*src)>) {
+    for_each_chunk(n, sizeof(T), [&](size_t first, size_t last) {
+      std::uninitialized_copy_n(src + first, last - first, dst + first);
+    });
+  } else {
+    std::uninitialized_copy_n(src, n, dst);
+  }
+}
+
+// value-initialize dst[0, n)
+template <typename T>
+void uninitialized_value_construct_n(T *dst, size_t n) {
+  if constexpr (std::is_nothrow_default_constructible_v<T>) {
+    for_each_chunk(n, sizeof(T), [&](size_t first, size_t last) {
+      std::uninitialized_value_construct_n(dst + first, last - first);
+    });
+  } else {
+    std::uninitialized_value_construct_n(dst, n);
+  }
+}
+
+// a[0, n) == b[0, n), chunks after a mismatch are skipped; arithmetic T is compared with simd, other T with ==
+template <typename T>
+bool equal(const T *a, const T *b, size_t n) {
+  auto same = std::atomic<bool>(true);
+  auto mutex = std::mutex();
+  auto error = std::exception_ptr();  // the first exception of a chunk, guarded by mutex
+  for_each_chunk(n, sizeof(T), [&](size_t first, size_t last) {
+    if (!same.load(std::memory_order_relaxed)) {
+      return;
+    }
+    try {
+      if (!simd::equal(a + first, b + first, last - first)) {
+        same.store(false, std::memory_order_relaxed);
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (error == nullptr) {
+        error = std::current_exception();
+      }
+      same.store(false, std::memory_order_relaxed);
+    }
+  });
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+  return same.load();
+}
+
+}  // namespace STL::parallel
@@ -0,0 +1,201 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace STL {
+
+/**
+ * Free-list slab of fixed-size blocks, one per (size, alignment) class, shared by every thread.
+ *
+ * @details
+ * Blocks are carved out of large chunks, freed blocks are kept in a free list and handed out again. Each thread
+ * keeps a small cache of free blocks and trades them with the shared list in batches, so most allocations and
+ * deallocations touch neither the lock nor malloc. Chunks are never given back: the memory held is the peak number
+ * of live blocks.
+ */
+template <size_t Size, size_t Align>
+class node_pool {
+ public:
+  struct free_node {
+    free_node *next_;
+  };
+
+  static constexpr size_t align = std::max(Align, alignof(free_node));
+  static constexpr size_t block_size = (std::max(Size, sizeof(free_node)) + align - 1) / align * align;
+  static constexpr size_t batch = std::max<size_t>(16, 4096 / block_size);  // blocks moved per trade
+  static constexpr size_t chunk_size = std::max<size_t>(64 * 1024, block_size * batch);
+
+  static void *allocate() {
+    if (exited_()) {
+      // the cache of this thread is gone (e.g. called from the destructor of another thread_local)
+      return getInstance().take_(1);
+    }
+    auto &cache = local_();
+    if (cache.head_ == nullptr) {
+      cache.head_ = getInstance().take_(batch);
+      cache.size_ = batch;
+    }
+    auto block = cache.head_;
+    cache.head_ = block->next_;
+    cache.size_--;
+    return block;
+  }
+
+  static void deallocate(void *p) noexcept {
+    auto block = static_cast<free_node *>(p);
+    if (exited_()) {
+      getInstance().give_(block, block);
+      return;
+    }
+    auto &cache = local_();
+    block->next_ = cache.head_;
+    cache.head_ = block;
+    if (++cache.size_ >= 2 * batch) {
+      cache.give_back(batch);
+    }
+  }
+
+  // blocks carved so far, free or not
+  static size_t blocks() {
+    auto &pool = getInstance();
+    std::lock_guard<std::mutex> lock(pool.mutex_);
+    return pool.carved_;
+  }
+
+ private:
+  /* blocks cached by one thread, returned to the shared list when the thread exits */
+  struct cache {
+    free_node *head_{nullptr};
+    size_t size_{0};
+
+    // hand the first count blocks to the shared list
+    void give_back(size_t count) {
+      auto first = head_;
+      auto last = head_;
+      for (size_t i = 1; i < count; i++) {
+        last = last->next_;
+      }
+      head_ = last->next_;
+      size_ -= count;
+      getInstance().give_(first, last);
+    }
+
+    ~cache() {
+      exited_() = true;
+      if (size_ > 0) {
+        give_back(size_);
+      }
+    }
+  };
+
+  std::mutex mutex_;
+  free_node *free_{nullptr};   // blocks given back by the threads
+  char *cur_{nullptr};         // next block to carve in the newest chunk
+  char *end_{nullptr};         // end of the newest chunk
+  std::vector<void *> chunks_;  // every chunk, kept reachable for the whole program
+  size_t carved_{0};
+
+  node_pool() = default;
+
+  // never destroyed: blocks may be returned by thread caches after static destruction began
+  static node_pool &getInstance() {
+    static auto instance = new node_pool();
+    return *instance;
+  }
+
+  static cache &local_() {
+    thread_local cache cache;
+    return cache;
+  }
+
+  // the cache of the calling thread was destroyed, trivially destructible so it outlives it
+  static bool &exited_() {
+    thread_local bool exited = false;
+    return exited;
+  }
+
+  // a chain of count blocks
+  free_node *take_(size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_node *head = nullptr;
+    for (size_t i = 0; i < count; i++) {
+      free_node *block;
+      if (free_ != nullptr) {
+        block = free_;
+        free_ = free_->next_;
+      } else {
+        if (cur_ == end_) {
+          cur_ = static_cast<char *>(::operator new(chunk_size, std::align_val_t(align)));
+          end_ = cur_ + chunk_size / block_size * block_size;
+          chunks_.push_back(cur_);
+        }
+        block = reinterpret_cast<free_node *>(cur_);
+        cur_ += block_size;
+        carved_++;
+      }
+      block->next_ = head;
+      head = block;
+    }
+    return head;
+  }
+
+  void give_(free_node *first, free_node *last) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    last->next_ = free_;
+    free_ = first;
+  }
+};
+
+/**
+ * Allocator adaptor of node_pool for node based containers, opted into by pooled_list. Since chunks are never
+ * given back, it suits containers of bounded or steady size rather than one-off large ones.
+ * Single objects come from the pool of their size, arrays from operator new. All instances are equal, so nodes may
+ * move freely between containers (e.g. by splice) and be freed by any thread.
+ */
+template <typename T>
+class pool_allocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_move_assignment = std::true_type;
+  using is_always_equal = std::true_type;
+
+  pool_allocator() noexcept = default;
+
+  template <typename U>
+  pool_allocator(const pool_allocator<U> & /* other */) noexcept {}
+
+  T *allocate(size_t n) {
+    if (n != 1) {
+      return std::allocator<T>().allocate(n);
+    }
+    return static_cast<T *>(pool_t::allocate());
+  }
+
+  void deallocate(T *p, size_t n) noexcept {
+    if (n != 1) {
+      std::allocator<T>().deallocate(p, n);
+      return;
+    }
+    pool_t::deallocate(p);
+  }
+
+  template <typename U>
+  bool operator==(const pool_allocator<U> & /* other */) const noexcept {
+    return true;
+  }
+
+  template <typename U>
+  bool operator!=(const pool_allocator<U> & /* other */) const noexcept {
+    return false;
+  }
+
+ private:
+  using pool_t = node_pool<sizeof(T), alignof(T)>;
+};
+
+}  // namespace STL
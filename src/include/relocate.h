@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace STL {
+
+/**
+ * A type is trivially relocatable if moving an object to a new address and destroying the source is
+ * equivalent to copying its bytes. All trivially copyable types are, and so are most types that only
+ * own heap memory through pointers (no pointer into themselves).
+ *
+ * @details
+ * Opt a type in with a specialization:
+ * <pre>
+ * template <>
+ * struct STL::is_trivially_relocatable<my_type> : std::true_type {};
+ * </pre>
+ */
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+/**
+ * Moves [src, src + size) into uninitialized dst and destroys the sources. The ranges may overlap.
+ * Trivially relocatable types are moved with a single memmove.
+ */
+template <typename T>
+void relocate(T *dst, T *src, size_t size) {
+  if (dst == src || size == 0) {
+    return;
+  }
+  if constexpr (is_trivially_relocatable_v<T>) {
+    std::memmove(static_cast<void *>(dst), static_cast<const void *>(src), size * sizeof(T));
+  } else if (dst < src) {
+    for (size_t i = 0; i < size; i++) {
+      ::new (static_cast<void *>(dst + i)) T(std::move_if_noexcept(src[i]));
+      src[i].~T();
+    }
+  } else {
+    for (size_t i = size; i > 0; i--) {
+      ::new (static_cast<void *>(dst + i - 1)) T(std::move_if_noexcept(src[i - 1]));
+      src[i - 1].~T();
+    }
+  }
+}
+
+}  // namespace STL
@@ -2,6 +2,7 @@
 #include <cstdlib>
 #include <iostream>
 #include <memory>
+#include "relocate.h"
 
 #define DEBUG
 
@@ -120,4 +121,8 @@ class shared_ptr {
   void view() { std::cout << "shared_ptr<" << typeid(T *).name() << ">(" << use_count() << ")" << std::endl; }
 };
 
+// shared_ptr only refers to the object and the counter through pointers
+template <typename T>
+struct is_trivially_relocatable<shared_ptr<T>> : std::true_type {};
+
 }  // namespace STL
@@ -0,0 +1,473 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define STL_SIMD_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * Vectorized kernels for linear scans over arrays of arithmetic values: equal, find, count, min_index, max_index.
+ *
+ * @details
+ * <ul>
+ * <li>SSE2 is used on every x86 CPU, AVX2 is compiled in with target attributes and picked at runtime.</li>
+ * <li>Every kernel returns exactly what the scalar loop returns, NaN included: floating point min/max stay scalar
+ * since SIMD min/max order NaN differently.</li>
+ * <li>Types other than integers (bool excluded), float and double always take the scalar loop.</li>
+ * </ul>
+ */
+namespace STL::simd {
+
+enum class isa { scalar, sse2, avx2 };
+
+inline isa detect() {
+#ifdef STL_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return isa::avx2;
+  }
+  return isa::sse2;
+#else
+  return isa::scalar;
+#endif
+}
+
+// read by the pool threads of parallel.h, relaxed is enough: every level computes the same result
+inline std::atomic<isa> &active_() {
+  static std::atomic<isa> active{detect()};
+  return active;
+}
+
+// instruction set the kernels dispatch to
+inline isa active() { return active_().load(std::memory_order_relaxed); }
+
+// restrict the kernels to at most level (e.g. to compare against the scalar loop), returns the level in use
+inline isa limit(isa level) {
+  auto best = detect();
+  level = level < best ? level : best;
+  active_().store(level, std::memory_order_relaxed);
+  return level;
+}
+
+template <typename T>
+inline constexpr bool supported_v =
+    (std::is_integral_v<T> && !std::is_same_v<T, bool>) || std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+namespace scalar {
+
+template <typename T>
+bool equal(const T *a, const T *b, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    if (a[i] != b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T>
+size_t find(const T *a, size_t n, const T &v) {
+  for (size_t i = 0; i < n; i++) {
+    if (a[i] == v) {
+      return i;
+    }
+  }
+  return n;
+}
+
+template <typename T>
+size_t count(const T *a, size_t n, const T &v) {
+  size_t cnt = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (a[i] == v) {
+      cnt++;
+    }
+  }
+  return cnt;
+}
+
+template <typename T>
+size_t min_index(const T *a, size_t n) {
+  size_t idx = 0;
+  for (size_t i = 1; i < n; i++) {
+    if (a[i] < a[idx]) {
+      idx = i;
+    }
+  }
+  return n == 0 ? 0 : idx;
+}
+
+template <typename T>
+size_t max_index(const T *a, size_t n) {
+  size_t idx = 0;
+  for (size_t i = 1; i < n; i++) {
+    if (a[idx] < a[i]) {
+      idx = i;
+    }
+  }
+  return n == 0 ? 0 : idx;
+}
+
+}  // namespace scalar
+
+#ifdef STL_SIMD_X86
+namespace detail {
+
+// the bits of v as an integer of the same size
+template <typename T>
+auto bits_(T v) {
+  using bits_t = std::conditional_t<
+      sizeof(T) == 1, uint8_t,
+      std::conditional_t<sizeof(T) == 2, uint16_t, std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+  bits_t b;
+  std::memcpy(&b, &v, sizeof(T));
+  return b;
+}
+
+// min_index/max_index on integers: pick the smaller (Max: larger) lane, then look for its first position
+template <typename T>
+inline constexpr bool minmax_supported_v = std::is_integral_v<T> && !std::is_same_v<T, bool>;
+
+/* ---------------------------------------------- SSE2 ---------------------------------------------- */
+
+template <typename T>
+inline __m128i splat128_(T v) {
+  auto b = bits_(v);
+  if constexpr (sizeof(T) == 1) {
+    return _mm_set1_epi8(static_cast<char>(b));
+  } else if constexpr (sizeof(T) == 2) {
+    return _mm_set1_epi16(static_cast<short>(b));
+  } else if constexpr (sizeof(T) == 4) {
+    return _mm_set1_epi32(static_cast<int>(b));
+  } else {
+    return _mm_set1_epi64x(static_cast<long long>(b));
+  }
+}
+
+// byte mask of the lanes of x equal to y: every byte of an equal lane is set
+template <typename T>
+inline int eq_mask128_(__m128i x, __m128i y) {
+  if constexpr (std::is_same_v<T, float>) {
+    return _mm_movemask_epi8(_mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(x), _mm_castsi128_ps(y))));
+  } else if constexpr (std::is_same_v<T, double>) {
+    return _mm_movemask_epi8(_mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(x), _mm_castsi128_pd(y))));
+  } else if constexpr (sizeof(T) == 1) {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(x, y));
+  } else if constexpr (sizeof(T) == 2) {
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(x, y));
+  } else if constexpr (sizeof(T) == 4) {
+    return _mm_movemask_epi8(_mm_cmpeq_epi32(x, y));
+  } else {
+    // no 64-bit compare in SSE2: both 32-bit halves must match
+    auto eq = _mm_cmpeq_epi32(x, y);
+    return _mm_movemask_epi8(_mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1))));
+  }
+}
+
+template <typename T>
+bool equal_sse2(const T *a, const T *b, size_t n) {
+  constexpr size_t lanes = 16 / sizeof(T);
+  size_t i = 0;
+  for (; i + lanes <= n; i += lanes) {
+    auto x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+    auto y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+    if (eq_mask128_<T>(x, y) != 0xFFFF) {
+      return false;
+    }
+  }
+  return scalar::equal(a + i, b + i, n - i);
+}
+
+template <typename T>
+size_t find_sse2(const T *a, size_t n, T v) {
+  constexpr size_t lanes = 16 / sizeof(T);
+  auto y = splat128_(v);
+  size_t i = 0;
+  for (; i + lanes <= n; i += lanes) {
+    auto mask = eq_mask128_<T>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)), y);
+    if (mask != 0) {
+      return i + __builtin_ctz(mask) / sizeof(T);
+    }
+  }
+  return i + scalar::find(a + i, n - i, v);
+}
+
+template <typename T>
+size_t count_sse2(const T *a, size_t n, T v) {
+  constexpr size_t lanes = 16 / sizeof(T);
+  auto y = splat128_(v);
+  size_t i = 0;
+  size_t cnt = 0;
+  for (; i + lanes <= n; i += lanes) {
+    auto mask = eq_mask128_<T>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)), y);
+    cnt += __builtin_popcount(mask);
+  }
+  return cnt / sizeof(T) + scalar::count(a + i, n - i, v);
+}
+
+// signed x > y per lane, unsigned lanes are compared after flipping their sign bit
+template <typename T>
+inline __m128i gt128_(__m128i x, __m128i y) {
+  if constexpr (std::is_unsigned_v<T>) {
+    auto sign = splat128_(static_cast<T>(T(1) << (sizeof(T) * 8 - 1)));
+    x = _mm_xor_si128(x, sign);
+    y = _mm_xor_si128(y, sign);
+  }
+  if constexpr (sizeof(T) == 1) {
+    return _mm_cmpgt_epi8(x, y);
+  } else if constexpr (sizeof(T) == 2) {
+    return _mm_cmpgt_epi16(x, y);
+  } else {
+    static_assert(sizeof(T) == 4);
+    return _mm_cmpgt_epi32(x, y);
+  }
+}
+
+template <typename T, bool Max>
+size_t minmax_sse2(const T *a, size_t n) {
+  constexpr size_t lanes = 16 / sizeof(T);
+  if constexpr (sizeof(T) == 8) {
+    // no 64-bit compare in SSE2
+    return Max ? scalar::max_index(a, n) : scalar::min_index(a, n);
+  } else {
+    if (n < 2 * lanes) {
+      return Max ? scalar::max_index(a, n) : scalar::min_index(a, n);
+    }
+    auto best = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a));
+    size_t i = lanes;
+    for (; i + lanes <= n; i += lanes) {
+      auto x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+      auto take = Max ? gt128_<T>(x, best) : gt128_<T>(best, x);
+      best = _mm_or_si128(_mm_and_si128(take, x), _mm_andnot_si128(take, best));
+    }
+    T lane[lanes];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lane), best);
+    auto v = lane[Max ? scalar::max_index(lane, lanes) : scalar::min_index(lane, lanes)];
+    for (; i < n; i++) {
+      if (Max ? v < a[i] : a[i] < v) {
+        v = a[i];
+      }
+    }
+    return find_sse2(a, n, v);
+  }
+}
+
+/* ---------------------------------------------- AVX2 ---------------------------------------------- */
+
+template <typename T>
+__attribute__((target("avx2"))) inline __m256i splat256_(T v) {
+  auto b = bits_(v);
+  if constexpr (sizeof(T) == 1) {
+    return _mm256_set1_epi8(static_cast<char>(b));
+  } else if constexpr (sizeof(T) == 2) {
+    return _mm256_set1_epi16(static_cast<short>(b));
+  } else if constexpr (sizeof(T) == 4) {
+    return _mm256_set1_epi32(static_cast<int>(b));
+  } else {
+    return _mm256_set1_epi64x(static_cast<long long>(b));
+  }
+}
+
+template <typename T>
+__attribute__((target("avx2"))) inline unsigned eq_mask256_(__m256i x, __m256i y) {
+  if constexpr (std::is_same_v<T, float>) {
+    auto eq = _mm256_cmp_ps(_mm256_castsi256_ps(x), _mm256_castsi256_ps(y), _CMP_EQ_OQ);
+    return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_castps_si256(eq)));
+  } else if constexpr (std::is_same_v<T, double>) {
+    auto eq = _mm256_cmp_pd(_mm256_castsi256_pd(x), _mm256_castsi256_pd(y), _CMP_EQ_OQ);
+    return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_castpd_si256(eq)));
+  } else if constexpr (sizeof(T) == 1) {
+    return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+  } else if constexpr (sizeof(T) == 2) {
+    return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(x, y)));
+  } else if constexpr (sizeof(T) == 4) {
+    return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(x, y)));
+  } else {
+    return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi64(x, y)));
+  }
+}
+
+template <typename T>
+__attribute__((target("avx2"))) bool equal_avx2(const T *a, const T *b, size_t n) {
+  constexpr size_t lanes = 32 / sizeof(T);
+  size_t i = 0;
+  for (; i + lanes <= n; i += lanes) {
+    auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+    auto y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+    if (eq_mask256_<T>(x, y) != 0xFFFFFFFFu) {
+      return false;
+    }
+  }
+  return scalar::equal(a + i, b + i, n - i);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) size_t find_avx2(const T *a, size_t n, T v) {
+  constexpr size_t lanes = 32 / sizeof(T);
+  auto y = splat256_(v);
+  size_t i = 0;
+  for (; i + lanes <= n; i += lanes) {
+    auto mask = eq_mask256_<T>(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)), y);
+    if (mask != 0) {
+      return i + __builtin_ctz(mask) / sizeof(T);
+    }
+  }
+  return i + scalar::find(a + i, n - i, v);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) size_t count_avx2(const T *a, size_t n, T v) {
+  constexpr size_t lanes = 32 / sizeof(T);
+  auto y = splat256_(v);
+  size_t i = 0;
+  size_t cnt = 0;
+  for (; i + lanes <= n; i += lanes) {
+    auto mask = eq_mask256_<T>(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)), y);
+    cnt += __builtin_popcount(mask);
+  }
+  return cnt / sizeof(T) + scalar::count(a + i, n - i, v);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) inline __m256i gt256_(__m256i x, __m256i y) {
+  if constexpr (std::is_unsigned_v<T>) {
+    auto sign = splat256_(static_cast<T>(T(1) << (sizeof(T) * 8 - 1)));
+    x = _mm256_xor_si256(x, sign);
+    y = _mm256_xor_si256(y, sign);
+  }
+  if constexpr (sizeof(T) == 1) {
+    return _mm256_cmpgt_epi8(x, y);
+  } else if constexpr (sizeof(T) == 2) {
+    return _mm256_cmpgt_epi16(x, y);
+  } else if constexpr (sizeof(T) == 4) {
+    return _mm256_cmpgt_epi32(x, y);
+  } else {
+    return _mm256_cmpgt_epi64(x, y);
+  }
+}
+
+template <typename T, bool Max>
+__attribute__((target("avx2"))) size_t minmax_avx2(const T *a, size_t n) {
+  constexpr size_t lanes = 32 / sizeof(T);
+  if (n < 2 * lanes) {
+    return Max ? scalar::max_index(a, n) : scalar::min_index(a, n);
+  }
+  auto best = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a));
+  size_t i = lanes;
+  for (; i + lanes <= n; i += lanes) {
+    auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+    auto take = Max ? gt256_<T>(x, best) : gt256_<T>(best, x);
+    best = _mm256_blendv_epi8(best, x, take);
+  }
+  T lane[lanes];
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(lane), best);
+  auto v = lane[Max ? scalar::max_index(lane, lanes) : scalar::min_index(lane, lanes)];
+  for (; i < n; i++) {
+    if (Max ? v < a[i] : a[i] < v) {
+      v = a[i];
+    }
+  }
+  return find_avx2(a, n, v);
+}
+
+}  // namespace detail
+#endif
+
+/* ------------------------------------------- dispatch ------------------------------------------- */
+
+// a[0, n) == b[0, n)
+template <typename T>
+bool equal(const T *a, const T *b, size_t n) {
+#ifdef STL_SIMD_X86
+  if constexpr (supported_v<T>) {
+    switch (active()) {
+      case isa::avx2:
+        return detail::equal_avx2(a, b, n);
+      case isa::sse2:
+        return detail::equal_sse2(a, b, n);
+      default:
+        break;
+    }
+  }
+#endif
+  return scalar::equal(a, b, n);
+}
+
+// index of the first element equal to v, n if there is none
+template <typename T>
+size_t find(const T *a, size_t n, const T &v) {
+#ifdef STL_SIMD_X86
+  if constexpr (supported_v<T>) {
+    switch (active()) {
+      case isa::avx2:
+        return detail::find_avx2(a, n, v);
+      case isa::sse2:
+        return detail::find_sse2(a, n, v);
+      default:
+        break;
+    }
+  }
+#endif
+  return scalar::find(a, n, v);
+}
+
+// number of elements equal to v
+template <typename T>
+size_t count(const T *a, size_t n, const T &v) {
+#ifdef STL_SIMD_X86
+  if constexpr (supported_v<T>) {
+    switch (active()) {
+      case isa::avx2:
+        return detail::count_avx2(a, n, v);
+      case isa::sse2:
+        return detail::count_sse2(a, n, v);
+      default:
+        break;
+    }
+  }
+#endif
+  return scalar::count(a, n, v);
+}
+
+// index of the first smallest element, 0 if n == 0
+template <typename T>
+size_t min_index(const T *a, size_t n) {
+#ifdef STL_SIMD_X86
+  if constexpr (detail::minmax_supported_v<T>) {
+    switch (active()) {
+      case isa::avx2:
+        return detail::minmax_avx2<T, false>(a, n);
+      case isa::sse2:
+        return detail::minmax_sse2<T, false>(a, n);
+      default:
+        break;
+    }
+  }
+#endif
+  return scalar::min_index(a, n);
+}
+
+// index of the first largest element, 0 if n == 0
+template <typename T>
+size_t max_index(const T *a, size_t n) {
+#ifdef STL_SIMD_X86
+  if constexpr (detail::minmax_supported_v<T>) {
+    switch (active()) {
+      case isa::avx2:
+        return detail::minmax_avx2<T, true>(a, n);
+      case isa::sse2:
+        return detail::minmax_sse2<T, true>(a, n);
+      default:
+        break;
+    }
+  }
+#endif
+  return scalar::max_index(a, n);
+}
+
+}  // namespace STL::simd
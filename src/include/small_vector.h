@@ -0,0 +1,473 @@
+#pragma once
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "relocate.h"
+#include "simd.h"
+#include "vector.h"
+
+#define DEBUG
+
+namespace STL {
+
+/**
+ * A vector that keeps up to N elements inside the object itself and only moves to the heap once it grows past N.
+ * The interface is the one of vector.
+ *
+ * @details
+ * Moving a small_vector whose elements are inline moves the elements one by one (or with one memcpy when they are
+ * trivially relocatable) instead of stealing a pointer.
+ */
+template <typename T, size_t N, typename Growth = growth::doubling, typename Alloc = std::allocator<T>>
+class small_vector {
+ private:
+  using alloc_traits = std::allocator_traits<Alloc>;
+
+  Alloc alloc_{};        // where arr_ comes from once it leaves buf_
+  T *arr_{inline_()};    // buf_ or a heap array, only [0, size_) is constructed
+  size_t size_{0};       // size of used memory/sizeof(T)
+  size_t capacity_{N};   // size of occupied memory/sizeof(T)
+  alignas(T) unsigned char buf_[(N > 0 ? N : 1) * sizeof(T)];  // the inline storage
+
+  T *inline_() noexcept { return reinterpret_cast<T *>(buf_); }
+
+  static void destroy_(T *first, T *last) {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      for (; first != last; first++) {
+        first->~T();
+      }
+    }
+  }
+
+  /* raw storage: the inline buffer is used whenever it is large enough */
+  T *allocate_(size_t size) { return size <= N ? inline_() : alloc_traits::allocate(alloc_, size); }
+  void deallocate_(T *arr, size_t size) {
+    if (arr != inline_()) {
+      alloc_traits::deallocate(alloc_, arr, size);
+    }
+  }
+
+  /* reallocate to exactly new_cap, existing elements are relocated */
+  void realloc_(size_t new_cap) {
+    auto new_arr = allocate_(new_cap);
+    if (new_arr == arr_) {
+      return;
+    }
+    relocate(new_arr, arr_, size_);
+    deallocate_(arr_, capacity_);
+    arr_ = new_arr;
+    capacity_ = new_arr == inline_() ? N : new_cap;
+  }
+
+  /* reallocate to exactly new_cap and construct a new element at idx in the new storage */
+  template <typename... Args>
+  void realloc_insert_(size_t idx, size_t new_cap, Args &&...args) {
+    auto new_arr = alloc_traits::allocate(alloc_, new_cap);
+    // construct first: args may refer to elements of the old storage
+    try {
+      ::new (static_cast<void *>(new_arr + idx)) T(std::forward<Args>(args)...);
+    } catch (...) {
+      alloc_traits::deallocate(alloc_, new_arr, new_cap);
+      throw;
+    }
+    relocate(new_arr, arr_, idx);
+    relocate(new_arr + idx + 1, arr_ + idx, size_ - idx);
+    deallocate_(arr_, capacity_);
+    arr_ = new_arr;
+    capacity_ = new_cap;
+    size_++;
+  }
+
+  /* open a gap of size elements at idx with at most one reallocation, fill(dst) constructs them at dst (or none) */
+  template <typename Fill>
+  void insert_n_(size_t idx, size_t size, Fill fill) {
+    if (size_ + size > capacity_) {
+      auto new_cap = next_capacity_(size_ + size);
+      auto new_arr = alloc_traits::allocate(alloc_, new_cap);
+      // fill first: the sources may be elements of the old storage
+      try {
+        fill(new_arr + idx);
+      } catch (...) {
+        alloc_traits::deallocate(alloc_, new_arr, new_cap);
+        throw;
+      }
+      relocate(new_arr, arr_, idx);
+      relocate(new_arr + idx + size, arr_ + idx, size_ - idx);
+      deallocate_(arr_, capacity_);
+      arr_ = new_arr;
+      capacity_ = new_cap;
+    } else {
+      relocate(arr_ + idx + size, arr_ + idx, size_ - idx);
+      try {
+        fill(arr_ + idx);
+      } catch (...) {
+        // fill constructs all or nothing, close the gap again
+        relocate(arr_ + idx, arr_ + idx + size, size_ - idx);
+        throw;
+      }
+    }
+    size_ += size;
+  }
+
+  /* capacity after the next expansion, at least required */
+  size_t next_capacity_(size_t required) const noexcept { return Growth::grow(capacity_, required, sizeof(T)); }
+
+  /* dynamic expansion: make room for required elements with at most one reallocation */
+  void resize_(size_t required) {
+    if (required > capacity_) {
+      realloc_(next_capacity_(required));
+    }
+  }
+
+  // take other's elements, other is left empty
+  void steal_(small_vector &other) {
+    if (other.is_inline()) {
+      relocate(arr_, other.arr_, other.size_);
+    } else {
+      arr_ = other.arr_;
+      capacity_ = other.capacity_;
+      other.arr_ = other.inline_();
+      other.capacity_ = N;
+    }
+    size_ = other.size_;
+    other.size_ = 0;
+  }
+
+ public:
+  using iterator = T *;              // random iterator
+  using const_iterator = const T *;  // constant iterator
+  using allocator_type = Alloc;
+
+ public:
+  // constructors
+  small_vector() = default;
+
+  explicit small_vector(const Alloc &alloc) : alloc_(alloc) {}
+
+  small_vector(T *arr, size_t size) : small_vector(arr, arr + size) {}
+
+  small_vector(T *first, T *last) {
+    // [first, last)
+    if (last <= first) {
+      throw std::exception();
+    }
+    auto size = static_cast<size_t>(last - first);
+    resize_(size);
+    std::uninitialized_copy(first, last, arr_);
+    size_ = size;
+  }
+
+  explicit small_vector(size_t size) { resize_(size); }
+
+  small_vector(size_t size, const T &value) {
+    resize_(size);
+    std::uninitialized_fill_n(arr_, size, value);
+    size_ = size;
+  }
+
+  small_vector(small_vector &&other) noexcept : alloc_(std::move(other.alloc_)) { steal_(other); }
+
+  small_vector(const small_vector &other) : alloc_(alloc_traits::select_on_container_copy_construction(other.alloc_)) {
+    resize_(other.size_);
+    std::uninitialized_copy(other.begin(), other.end(), arr_);
+    size_ = other.size_;
+  }
+
+  small_vector(std::initializer_list<T> init) {
+    resize_(init.size());
+    std::uninitialized_copy(init.begin(), init.end(), arr_);
+    size_ = init.size();
+  }
+
+  // destructor
+  ~small_vector() {
+    destroy_(begin(), end());
+    deallocate_(arr_, capacity_);
+  }
+
+  // iterator
+  iterator begin() { return arr_; }
+  iterator end() { return arr_ + size_; }
+  const_iterator begin() const { return arr_; }
+  const_iterator end() const { return arr_ + size_; }
+
+  // modifier
+  void push_back(const T &value) { emplace_back(value); }
+  void push_back(T &&value) { emplace_back(std::move(value)); }
+
+  template <typename... Args>
+  T &emplace_back(Args &&...args) {
+    if (size_ == capacity_) {
+      realloc_insert_(size_, next_capacity_(size_ + 1), std::forward<Args>(args)...);
+    } else {
+      ::new (static_cast<void *>(arr_ + size_)) T(std::forward<Args>(args)...);
+      size_++;
+    }
+    return arr_[size_ - 1];
+  }
+
+  void pop_back() {
+    size_--;
+    arr_[size_].~T();
+  }
+
+  void clear() {
+    destroy_(begin(), end());
+    size_ = 0;
+  }
+
+  void erase(iterator pos) {
+    if (pos < begin() || pos >= end()) {
+      return;
+    }
+    pos->~T();
+    relocate(pos, pos + 1, end() - pos - 1);
+    size_--;
+  }
+
+  void erase(iterator first, iterator last) {
+    if (first < begin() || first >= end()) {
+      return;
+    }
+    if (last > end()) {
+      last = end();
+    }
+    destroy_(first, last);
+    relocate(first, last, end() - last);
+    size_ -= (last - first);
+  }
+
+  template <typename... Args>
+  iterator emplace(iterator pos, Args &&...args) {
+    if (pos < begin() || pos > end()) {
+      throw std::exception();
+    }
+    auto idx = static_cast<size_t>(pos - begin());
+    if (size_ == capacity_) {
+      realloc_insert_(idx, next_capacity_(size_ + 1), std::forward<Args>(args)...);
+    } else if (idx == size_) {
+      ::new (static_cast<void *>(arr_ + idx)) T(std::forward<Args>(args)...);
+      size_++;
+    } else {
+      // args may refer to an element that is about to be shifted
+      T tmp(std::forward<Args>(args)...);
+      relocate(arr_ + idx + 1, arr_ + idx, size_ - idx);
+      ::new (static_cast<void *>(arr_ + idx)) T(std::move(tmp));
+      size_++;
+    }
+    return arr_ + idx;
+  }
+
+  void insert(iterator pos, const T &value) { insert(pos, 1, value); }
+
+  void insert(iterator pos, size_t size, const T &value) {
+    if (pos < begin() || pos > end()) {
+      throw std::exception();
+    }
+    auto idx = static_cast<size_t>(pos - begin());
+    if (size == 0) {
+      return;
+    }
+    if (size_ + size <= capacity_ && &value >= begin() && &value < end()) {
+      // value lives inside arr_ and is about to be shifted
+      T tmp(value);
+      insert_n_(idx, size, [&](T *dst) { std::uninitialized_fill_n(dst, size, tmp); });
+      return;
+    }
+    insert_n_(idx, size, [&](T *dst) { std::uninitialized_fill_n(dst, size, value); });
+  }
+
+  template <typename InputIt, typename = std::enable_if_t<is_input_iterator_v<InputIt>>>
+  void insert(iterator pos, InputIt first, InputIt last) {
+    if (pos < begin() || pos > end()) {
+      throw std::exception();
+    }
+    auto idx = static_cast<size_t>(pos - begin());
+    if constexpr (is_forward_iterator_v<InputIt>) {
+      auto size = static_cast<size_t>(std::distance(first, last));
+      if (size == 0) {
+        return;
+      }
+      if constexpr (std::is_pointer_v<InputIt>) {
+        if (size_ + size <= capacity_ && first < end() && last > begin()) {
+          // [first, last) is a part of arr_ that is about to be shifted, copy it aside
+          auto tmp = small_vector(alloc_);
+          tmp.append(first, last);
+          insert_n_(idx, size, [&](T *dst) {
+            relocate(dst, tmp.arr_, size);
+            tmp.size_ = 0;
+          });
+          return;
+        }
+      }
+      insert_n_(idx, size, [&](T *dst) { std::uninitialized_copy(first, last, dst); });
+    } else {
+      // single pass: the length is unknown until the end, append then rotate into place
+      auto old_size = size_;
+      for (; first != last; ++first) {
+        emplace_back(*first);
+      }
+      std::rotate(begin() + idx, begin() + old_size, end());
+    }
+  }
+
+  template <typename InputIt, typename = std::enable_if_t<is_input_iterator_v<InputIt>>>
+  void append(InputIt first, InputIt last) {
+    insert(end(), first, last);
+  }
+
+  template <typename InputIt, typename = std::enable_if_t<is_input_iterator_v<InputIt>>>
+  void assign(InputIt first, InputIt last) {
+    if constexpr (std::is_pointer_v<InputIt>) {
+      if (first < end() && last > begin()) {
+        // [first, last) is a part of arr_ that clear() would destroy
+        auto tmp = small_vector(alloc_);
+        tmp.append(first, last);
+        *this = std::move(tmp);
+        return;
+      }
+    }
+    clear();
+    append(first, last);
+  }
+
+  void resize(size_t size) {
+    if (size < size_) {
+      destroy_(arr_ + size, end());
+    } else {
+      resize_(size);
+      std::uninitialized_value_construct(arr_ + size_, arr_ + size);
+    }
+    size_ = size;
+  }
+
+  void resize(size_t size, T value) {
+    if (size < size_) {
+      destroy_(arr_ + size, end());
+    } else {
+      resize_(size);
+      std::uninitialized_fill(arr_ + size_, arr_ + size, value);
+    }
+    size_ = size;
+  }
+
+  void swap(small_vector &other) {
+    if (!is_inline() && !other.is_inline()) {
+      std::swap(arr_, other.arr_);
+      std::swap(size_, other.size_);
+      std::swap(capacity_, other.capacity_);
+      if constexpr (alloc_traits::propagate_on_container_swap::value) {
+        std::swap(alloc_, other.alloc_);
+      }
+    } else {
+      // inline elements have to be moved one way or the other
+      auto tmp = small_vector(std::move(other));
+      other = std::move(*this);
+      *this = std::move(tmp);
+    }
+  }
+
+  Alloc get_allocator() const { return alloc_; }
+
+  // capacity
+  bool empty() const noexcept { return size_ == 0; }
+  size_t max_size() const noexcept { return alloc_traits::max_size(alloc_); }
+  size_t size() const noexcept { return size_; }
+  size_t capacity() const noexcept { return capacity_; }
+  T *data() { return arr_; }
+  void reserve(size_t new_cap) {
+    if (new_cap > capacity_) {
+      realloc_(new_cap);
+    }
+  }
+  void shrink_to_fit() {
+    // moves back inline once the elements fit
+    if (!is_inline() && capacity_ > size_) {
+      realloc_(size_);
+    }
+  }
+
+  // search, vectorized for arithmetic T
+  iterator find(const T &value) { return arr_ + simd::find(arr_, size_, value); }
+  const_iterator find(const T &value) const { return arr_ + simd::find(arr_, size_, value); }
+  size_t count(const T &value) const { return simd::count(arr_, size_, value); }
+  bool contains(const T &value) const { return find(value) != end(); }
+  iterator min_element() { return empty() ? end() : arr_ + simd::min_index(arr_, size_); }
+  iterator max_element() { return empty() ? end() : arr_ + simd::max_index(arr_, size_); }
+
+  // elements are stored in the object itself
+  bool is_inline() const noexcept { return arr_ == reinterpret_cast<const T *>(buf_); }
+  static constexpr size_t inline_capacity() noexcept { return N; }
+
+  // operator
+  T &operator[](size_t pos) { return arr_[pos]; }
+  const T &operator[](size_t pos) const { return arr_[pos]; }
+
+  small_vector &operator=(const small_vector &other) {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+      if (alloc_ != other.alloc_) {
+        realloc_(0);
+        alloc_ = other.alloc_;
+      }
+    }
+    resize_(other.size_);
+    std::uninitialized_copy(other.begin(), other.end(), arr_);
+    size_ = other.size_;
+    return *this;
+  }
+
+  small_vector &operator=(small_vector &&other) noexcept(alloc_traits::propagate_on_container_move_assignment::value ||
+                                                         alloc_traits::is_always_equal::value) {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    if (!other.is_inline() && !alloc_traits::propagate_on_container_move_assignment::value &&
+        !alloc_traits::is_always_equal::value && alloc_ != other.alloc_) {
+      // other's buffer cannot be released by alloc_, move the elements instead
+      resize_(other.size_);
+      relocate(arr_, other.arr_, other.size_);
+      size_ = other.size_;
+      other.size_ = 0;
+      return *this;
+    }
+    realloc_(0);
+    if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+      alloc_ = std::move(other.alloc_);
+    }
+    steal_(other);
+    return *this;
+  }
+
+  bool operator==(const small_vector &other) const {
+    // small sizes: compare on the calling thread, without the dispatch of parallel::equal
+    return size_ == other.size_ && simd::equal(arr_, other.arr_, size_);
+  }
+  bool operator!=(const small_vector &other) const { return !(*this == other); }
+
+  // debug helper
+  void view() {
+#ifdef DEBUG
+    std::cout << "small_vector<" << N << "> => sz(" << size_ << ") cap(" << capacity_ << ")"
+              << (is_inline() ? " inline" : "") << " : [";
+    if (size_ > 0) {
+      for (size_t i = 0; i < size_ - 1; i++) {
+        std::cout << arr_[i] << ",";
+      }
+      std::cout << arr_[size_ - 1];
+    }
+    std::cout << "]" << std::endl;
+#endif
+  }
+};
+
+}  // namespace STL
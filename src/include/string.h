@@ -1,6 +1,9 @@
 #pragma once
 #include <cstring>
+#include <functional>
 #include <iostream>
+#include <string_view>
+#include "relocate.h"
 
 namespace STL {
 
@@ -17,6 +20,15 @@ class string {
     }
   }
 
+  // the size chars at chars, which need not be null-terminated (e.g. a slice of a buffer)
+  string(const char *chars, size_t size) {
+    chars_ = new char[size + 1];
+    memcpy(chars_, chars, size);
+    chars_[size] = '\0';
+  }
+
+  explicit string(std::string_view sv) : string(sv.data(), sv.size()) {}
+
   // copy constructor
   string(const string &str) {
     chars_ = new char[strlen(str.chars_) + 1];
@@ -37,6 +49,7 @@ class string {
     delete[] chars_;
     chars_ = new char[strlen(chars) + 1];
     strcpy(chars_, chars);
+    return *this;
   }
 
   // copy assign
@@ -47,6 +60,7 @@ class string {
     delete[] chars_;
     chars_ = new char[strlen(other.chars_) + 1];
     strcpy(chars_, other.chars_);
+    return *this;
   }
 
   // move assign
@@ -57,12 +71,20 @@ class string {
     delete[] chars_;
     chars_ = other.chars_;
     other.chars_ = nullptr;
+    return *this;
   }
 
   // operator ==
   friend bool operator==(const string &str1, const string &str2) { return strcmp(str1.chars_, str2.chars_) == 0; }
+  friend bool operator==(const string &str, std::string_view sv) { return std::string_view(str) == sv; }
+  friend bool operator==(std::string_view sv, const string &str) { return std::string_view(str) == sv; }
+
+  // a view of the chars, valid until the string changes (empty for a moved-from string)
+  operator std::string_view() const noexcept {
+    return chars_ == nullptr ? std::string_view() : std::string_view(chars_, strlen(chars_));
+  }
 
-  size_t size() const { return strlen(chars_); }
+  size_t size() const { return std::string_view(*this).size(); }
 
   const char *c_str() const { return chars_; }
 
@@ -79,4 +101,18 @@ class string {
  private:
   char *chars_{};
 };
+
+/**
+ * Transparent hasher of strings: string, std::string, std::string_view and const char* with the same chars hash the
+ * same, so that an unordered_map<string, T, string_hash> can be searched with any of them without building a string.
+ */
+struct string_hash {
+  using is_transparent = void;
+
+  size_t operator()(std::string_view sv) const noexcept { return std::hash<std::string_view>()(sv); }
+};
+
+// string only refers to its chars through chars_
+template <>
+struct is_trivially_relocatable<string> : std::true_type {};
 }  // namespace STL
@@ -0,0 +1,182 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <unordered_set>
+#include <vector>
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+namespace STL {
+
+/**
+ * Memory telemetry of containers, per container type: bytes reserved vs bytes used by the live instances, number of
+ * reallocations and bytes copied while growing.
+ *
+ * @details
+ * Opt-in per container type: pass telemetry::on as the Telemetry parameter of vector, e.g.
+ * vector<T, growth::doubling, std::allocator<T>, telemetry::on>, then call telemetry::report(std::cout) or
+ * telemetry::collect(). The default, telemetry::off, records nothing and leaves the layout of vector as it is; being
+ * part of the type, the choice cannot differ between translation units.
+ * Instances are measured when a snapshot is taken, so take it while the containers are not being modified.
+ */
+namespace telemetry {
+
+struct snapshot {
+  std::string type;
+  size_t instances{0};
+  size_t bytes_reserved{0};
+  size_t bytes_used{0};
+  size_t reallocations{0};
+  size_t bytes_copied{0};
+};
+
+/* statistics of one container type, shared by all its instances */
+class type_stats {
+ public:
+  using measure_fn = void (*)(const void *container, size_t &reserved, size_t &used);
+
+  type_stats(std::string type, measure_fn measure);
+
+  type_stats(const type_stats &) = delete;
+  type_stats &operator=(const type_stats &) = delete;
+
+  void attach(const void *container) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    live_.insert(container);
+  }
+
+  void detach(const void *container) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    live_.erase(container);
+  }
+
+  void reallocated(size_t bytes_copied) {
+    reallocations_.fetch_add(1, std::memory_order_relaxed);
+    bytes_copied_.fetch_add(bytes_copied, std::memory_order_relaxed);
+  }
+
+  snapshot take() {
+    auto snap = snapshot();
+    snap.type = type_;
+    snap.reallocations = reallocations_.load(std::memory_order_relaxed);
+    snap.bytes_copied = bytes_copied_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    snap.instances = live_.size();
+    for (auto container : live_) {
+      size_t reserved = 0;
+      size_t used = 0;
+      measure_(container, reserved, used);
+      snap.bytes_reserved += reserved;
+      snap.bytes_used += used;
+    }
+    return snap;
+  }
+
+ private:
+  std::string type_;
+  measure_fn measure_;
+  std::mutex mutex_;                      // guards live_
+  std::unordered_set<const void *> live_;  // instances alive right now
+  std::atomic<size_t> reallocations_{0};
+  std::atomic<size_t> bytes_copied_{0};
+};
+
+/* every type_stats ever created, a snapshot walks them all */
+class registry {
+ public:
+  static registry &getInstance() {
+    static registry instance;
+    return instance;
+  }
+
+  void add(type_stats *stats) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.push_back(stats);
+  }
+
+  std::vector<snapshot> collect() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto snaps = std::vector<snapshot>();
+    for (auto stats : stats_) {
+      snaps.push_back(stats->take());
+    }
+    return snaps;
+  }
+
+ private:
+  registry() = default;
+  registry(const registry &) = delete;
+  void operator=(const registry &) = delete;
+
+  std::mutex mutex_;
+  std::vector<type_stats *> stats_;
+};
+
+inline type_stats::type_stats(std::string type, measure_fn measure) : type_(std::move(type)), measure_(measure) {
+  registry::getInstance().add(this);
+}
+
+inline std::string type_name(const std::type_info &info) {
+#ifdef __GNUG__
+  int status = 0;
+  auto name = abi::__cxa_demangle(info.name(), nullptr, nullptr, &status);
+  if (status == 0) {
+    auto demangled = std::string(name);
+    std::free(name);
+    return demangled;
+  }
+#endif
+  return info.name();
+}
+
+/* the statistics of container type C, which must provide value_type, size() and capacity() */
+template <typename C>
+type_stats &stats_of() {
+  static type_stats stats(type_name(typeid(C)), [](const void *container, size_t &reserved, size_t &used) {
+    auto c = static_cast<const C *>(container);
+    reserved = c->capacity() * sizeof(typename C::value_type);
+    used = c->size() * sizeof(typename C::value_type);
+  });
+  return stats;
+}
+
+/* a base of an instrumented container: registers the owner for its whole lifetime */
+template <typename C>
+class probe {
+ public:
+  explicit probe(const C *owner) : owner_(owner) { stats_of<C>().attach(owner_); }
+  probe(const probe &) = delete;
+  probe &operator=(const probe &) = delete;
+  ~probe() { stats_of<C>().detach(owner_); }
+
+  void reallocated(size_t bytes_copied) { stats_of<C>().reallocated(bytes_copied); }
+
+ private:
+  const C *owner_;
+};
+
+/* the Telemetry parameter of an instrumented container */
+struct on {
+  template <typename C>
+  using probe = telemetry::probe<C>;
+};
+
+inline std::vector<snapshot> collect() { return registry::getInstance().collect(); }
+
+inline void report(std::ostream &os) {
+  for (auto &snap : collect()) {
+    os << snap.type << " => instances(" << snap.instances << ") reserved(" << snap.bytes_reserved << "B) used("
+       << snap.bytes_used << "B) reallocations(" << snap.reallocations << ") copied(" << snap.bytes_copied << "B)"
+       << std::endl;
+  }
+}
+
+}  // namespace telemetry
+
+}  // namespace STL
@@ -2,8 +2,12 @@
 #include <cmath>
 #include <cstdlib>
 #include <functional>
+#include <iterator>
 #include <memory>
 #include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include "list.h"
 #include "shared_ptr.h"
 #include "vector.h"
@@ -12,129 +16,396 @@
 
 namespace STL {
 
-template <typename Key, typename T, class Hash = std::hash<Key>>
+// Hash::is_transparent: the hasher accepts other types than the key (e.g. string_hash), lookups may take them as is
+template <typename Hash, typename = void>
+struct is_transparent : std::false_type {};
+
+template <typename Hash>
+struct is_transparent<Hash, std::void_t<typename Hash::is_transparent>> : std::true_type {};
+
+template <typename Hash>
+inline constexpr bool is_transparent_v = is_transparent<Hash>::value;
+
+template <typename Key, typename T, class Hash = std::hash<Key>, class Alloc = std::allocator<std::pair<const Key, T>>>
 class unordered_map {
  public:
   using kv_t = std::pair<const Key, T>;
-  using const_iterator = typename list<kv_t>::const_iterator;
-  using iterator = typename list<kv_t>::iterator;
+  using allocator_type = Alloc;
 
  private:
+  template <typename U>
+  using rebind_t = typename std::allocator_traits<Alloc>::template rebind_alloc<U>;
+
+  // an element of kvs_: the pair and the full hash of its key, so that erase finds its bucket without the hasher
+  struct entry_t {
+    kv_t kv_;
+    size_t hash_{0};
+
+    template <typename... Args, typename = std::enable_if_t<std::is_constructible_v<kv_t, Args &&...>>>
+    explicit entry_t(Args &&...args) : kv_(std::forward<Args>(args)...) {}
+  };
+
+  using entries_t = list<entry_t, rebind_t<entry_t>>;
+
+ public:
+  // bidirectional iterator over the pairs of kvs_, V is kv_t or const kv_t
+  template <typename V>
+  class Iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = kv_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = V *;
+    using reference = V &;
+
+    typename entries_t::iterator itr_;
+
+   public:
+    Iterator() = default;
+    explicit Iterator(typename entries_t::iterator itr) : itr_(itr) {}
+    // iterator => const_iterator
+    template <typename U, typename = std::enable_if_t<std::is_same_v<V, const U>>>
+    Iterator(const Iterator<U> &other) : itr_(other.itr_) {}
+
+    V &operator*() const { return entry_().kv_; }
+    V *operator->() const { return &entry_().kv_; }
+    // the full hash of the key
+    size_t hash() const { return entry_().hash_; }
+
+    Iterator &operator++() {
+      ++itr_;
+      return *this;
+    }
+    Iterator operator++(int) {
+      auto old = *this;
+      ++itr_;
+      return old;
+    }
+    Iterator &operator--() {
+      --itr_;
+      return *this;
+    }
+    Iterator operator--(int) {
+      auto old = *this;
+      --itr_;
+      return old;
+    }
+
+    bool operator==(const Iterator &other) const { return itr_ == other.itr_; }
+    bool operator!=(const Iterator &other) const { return itr_ != other.itr_; }
+
+   private:
+    entry_t &entry_() const {
+      auto itr = itr_;
+      return *itr;
+    }
+  };
+
+  using iterator = Iterator<kv_t>;
+  using const_iterator = Iterator<const kv_t>;
+
+ private:
+  // an entry of a bucket: the full hash of the key is kept, so that rehashing never calls the hasher again and
+  // lookups compare keys only when hashes are equal
+  struct slot_t {
+    size_t hash_;
+    iterator itr_;
+  };
+
+  using bucket_t = list<slot_t, rebind_t<slot_t>>;
+  using table_t = vector<bucket_t, growth::doubling, rebind_t<bucket_t>>;
+
   /* a table  => multiple buckets
    * a bucket => multiple kv pairs (might be duplicate keys)
    */
-  vector<list<iterator>> buckets_;  // bucket with multiple iterator/location in
-  list<kv_t> kvs_;                  // all elements (unordered)
+  table_t buckets_;  // bucket with multiple iterator/location in
+  entries_t kvs_;    // all elements (unordered)
 
   size_t size_{0};      // number of kv pairs; size of kvs_
   size_t capacity_{1};  // for hash modula;    size of buckets_
 
-  Hash hash_func_{std::hash<Key>()};
+  /* incremental rehash: buckets_ is built, then the previous table is moved into it from its last bucket, a few
+   * buckets per insert/erase. Only [0, buckets_.size()) is constructed until the build is over, and the old buckets
+   * [old_buckets_.size(), old_capacity_) are migrated (and destroyed).
+   */
+  table_t old_buckets_;      // the previous table while a rehash is in progress
+  size_t old_capacity_{0};   // bucket count of the previous table, 0 when no rehash is in progress
+  bool incremental_{false};  // grow incrementally instead of rehashing at once
+
+  Hash hash_func_{Hash()};
   float max_load_factor_{1.5};  // determine the average max number of kv pairs within a bucket
 
   size_t hash_(const Key &key) { return hash_func_(key) % capacity_; }
 
   size_t hash_(const kv_t &elem) { return hash_func_(elem.first) % capacity_; }
 
-  std::optional<iterator> get_(const Key &key) {
-    auto i = hash_(key);
-    for (auto itr = buckets_[i].begin(); itr != buckets_[i].end(); itr++) {
-      if (itr.node_->val_->first == key) {
-        return std::optional<iterator>(*itr);
+  // the entry of key in bucket, h is the hash of key
+  template <typename K>
+  static std::optional<typename bucket_t::iterator> find_in_(const bucket_t &bucket, const K &key, size_t h) {
+    for (auto itr = bucket.begin(); itr != bucket.end(); itr++) {
+      if (itr->hash_ == h && itr->itr_->first == key) {
+        return std::optional<typename bucket_t::iterator>(itr);
       }
     }
-    return std::optional<iterator>();
+    return std::optional<typename bucket_t::iterator>();
   }
 
-  std::optional<iterator> get_(const kv_t &elem) { return get_(elem.first); }
+  // remove the entry of pos from bucket
+  static void unlink_from_(bucket_t &bucket, iterator pos) {
+    for (auto itr = bucket.begin(); itr != bucket.end(); itr++) {
+      if (itr->itr_ == pos) {
+        bucket.erase(itr);
+        return;
+      }
+    }
+  }
+
+  // the bucket of hash h: the old one until it is migrated
+  const bucket_t &bucket_of_(size_t h) const {
+    if (old_capacity_ != 0 && h % old_capacity_ < old_buckets_.size()) {
+      return old_buckets_[h % old_capacity_];
+    }
+    return buckets_[h % capacity_];
+  }
 
-  // insert or assign
-  void insert_(const kv_t &elem, bool assign = false) {
-    std::optional<iterator> opt = get_(elem);
+  bucket_t &bucket_of_(size_t h) { return const_cast<bucket_t &>(std::as_const(*this).bucket_of_(h)); }
+
+  // h is the hash of key, K is Key or any type a transparent Hash accepts; a lookup never modifies the map
+  template <typename K>
+  std::optional<iterator> get_(const K &key, size_t h) const {
+    auto opt = find_in_(bucket_of_(h), key, h);
     if (opt.has_value()) {
-      if (assign) {
-        opt.value().node_->val_.second = elem.second;
-      }
-      return;
+      return std::optional<iterator>(opt.value()->itr_);
     }
+    return std::optional<iterator>();
+  }
 
-    // insert into kv list
-    kvs_.push_back(elem);
-    // insert into specific bucket
-    auto itr = kvs_.end();
-    itr--;
-    auto i = hash_(elem);
-    buckets_[i].push_back(itr);
+  template <typename K>
+  std::optional<iterator> get_(const K &key) const {
+    return get_(key, hash_func_(key));
+  }
+
+  // heterogeneous lookups are enabled by a transparent Hash, keys must then compare equal (==) to K
+  template <typename K>
+  using if_transparent_t = std::enable_if_t<is_transparent_v<Hash> && !std::is_same_v<std::decay_t<K>, Key>>;
 
+  // index the new entry itr of hash h, then grow (or go on migrating) the table
+  void link_(size_t h, iterator itr) {
+    itr.itr_->hash_ = h;
+    bucket_of_(h).push_back({h, itr});
     size_++;
     if (size_ > max_load_factor_ * capacity_) {
-      rehash_(capacity_ * 2);
+      if (incremental_) {
+        start_rehash_(capacity_ * 2);
+      } else {
+        rehash_(capacity_ * 2);
+      }
+    } else {
+      rehash_step_();
     }
   }
 
-  void rehash_(size_t count) {
+  // the entry of key, or a new one whose value is made of args: one hash, one probe
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> try_emplace_(K &&key, Args &&...args) {
+    return try_emplace_hashed_(hash_func_(key), std::forward<K>(key), std::forward<Args>(args)...);
+  }
+
+  // try_emplace_ with h, the hash of key, already computed
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> try_emplace_hashed_(size_t h, K &&key, Args &&...args) {
+    auto opt = get_(key, h);
+    if (opt.has_value()) {
+      return {opt.value(), false};
+    }
+    kvs_.emplace_back(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                      std::forward_as_tuple(std::forward<Args>(args)...));
+    auto itr = iterator(--kvs_.end());
+    link_(h, itr);
+    return {itr, true};
+  }
+
+  // count empty buckets sharing the allocator of kvs_
+  void reset_buckets_(size_t count) {
     buckets_.clear();
-    buckets_.resize(count);
+    buckets_.resize(count, bucket_t(rebind_t<slot_t>(kvs_.get_allocator())));
+  }
+
+  // drop the previous table of an incremental rehash, its entries are all in kvs_
+  void drop_old_buckets_() {
+    old_buckets_.clear();
+    old_buckets_.shrink_to_fit();
+    old_capacity_ = 0;
+  }
+
+  // construct the buckets of buckets_ up to count
+  void build_buckets_(size_t count) {
+    while (buckets_.size() < count) {
+      buckets_.emplace_back(rebind_t<slot_t>(kvs_.get_allocator()));
+    }
+  }
+
+  // build the table from scratch out of the hashes kept in kvs_: for tables that do not hold its entries yet
+  void rebuild_(size_t count) {
+    drop_old_buckets_();
+    reset_buckets_(count);
     capacity_ = count;
     for (auto itr = kvs_.begin(); itr != kvs_.end(); itr++) {
-      insert_(*itr);
+      buckets_[itr->hash_ % capacity_].push_back({itr->hash_, iterator(itr)});
+    }
+  }
+
+  // move the slots of old into buckets_ by their cached hash, relinking their nodes
+  void redistribute_(bucket_t &old) {
+    while (!old.empty()) {
+      auto itr = old.begin();
+      auto &bucket = buckets_[itr->hash_ % capacity_];
+      bucket.splice(bucket.end(), old, itr);
+    }
+  }
+
+  void redistribute_(table_t &table) {
+    for (auto &old : table) {
+      redistribute_(old);
+    }
+  }
+
+  // rehash at once to count buckets, without calling the hasher
+  void rehash_(size_t count) {
+    auto table = std::move(buckets_);
+    reset_buckets_(count);
+    capacity_ = count;
+    redistribute_(table);
+    redistribute_(old_buckets_);
+    drop_old_buckets_();
+  }
+
+  // set the current table aside and allocate one of count buckets, left unconstructed for the next rehash steps
+  void start_rehash_(size_t count) {
+    if (old_capacity_ != 0) {
+      // still migrating from the previous growth
+      rehash_(count);
+      return;
+    }
+    old_buckets_.swap(buckets_);
+    old_capacity_ = capacity_;
+    buckets_.reserve(count);
+    capacity_ = count;
+    rehash_step_();
+  }
+
+  // up to rehash_step steps: each constructs a bucket of the new table or, once all are, moves the last old bucket
+  // into it by relinking its nodes and destroys it (no allocation)
+  void rehash_step_() {
+    if (old_capacity_ == 0) {
+      return;
+    }
+    for (size_t n = 0; n < rehash_step && !old_buckets_.empty(); n++) {
+      if (buckets_.size() < capacity_) {
+        build_buckets_(buckets_.size() + 1);
+        continue;
+      }
+      redistribute_(old_buckets_[old_buckets_.size() - 1]);
+      old_buckets_.pop_back();
+    }
+    if (old_buckets_.empty()) {
+      drop_old_buckets_();
     }
   }
 
  public:
+  static constexpr size_t rehash_step = 16;  // old buckets migrated per insert/erase in incremental mode
+  static constexpr size_t batch_size = 16;   // keys in flight in find_batch/insert_batch
+
   // constructor
-  explicit unordered_map(size_t capacity = 1) : capacity_(capacity) { buckets_.resize(capacity); }
+  explicit unordered_map(size_t capacity = 1, const Alloc &alloc = Alloc())
+      : buckets_(rebind_t<bucket_t>(alloc)),
+        kvs_(rebind_t<entry_t>(alloc)),
+        capacity_(capacity),
+        old_buckets_(rebind_t<bucket_t>(alloc)) {
+    reset_buckets_(capacity);
+  }
+
+  explicit unordered_map(const Alloc &alloc) : unordered_map(1, alloc) {}
 
-  unordered_map(std::initializer_list<kv_t> init) {
+  unordered_map(std::initializer_list<kv_t> init, const Alloc &alloc = Alloc())
+      : buckets_(rebind_t<bucket_t>(alloc)), kvs_(rebind_t<entry_t>(alloc)), old_buckets_(rebind_t<bucket_t>(alloc)) {
     rehash_(std::ceil(init.size() / max_load_factor()));
     for (auto itr = init.begin(); itr != init.end(); itr++) {
-      insert_(*itr);
+      insert(*itr);
     }
   }
 
-  unordered_map(const unordered_map<Key, T, Hash> &other) {
-    buckets_ = other.buckets_;
-    kvs_ = other.kvs_;
+  unordered_map(const unordered_map<Key, T, Hash, Alloc> &other)
+      : buckets_(rebind_t<bucket_t>(
+            std::allocator_traits<Alloc>::select_on_container_copy_construction(other.get_allocator()))),
+        kvs_(other.kvs_),
+        old_buckets_(rebind_t<bucket_t>(kvs_.get_allocator())) {
     size_ = other.size_;
-    capacity_ = other.capacity_;
     hash_func_ = other.hash_func_;
     max_load_factor_ = other.max_load_factor_;
+    incremental_ = other.incremental_;
+    rebuild_(other.capacity_);
   }
 
-  unordered_map(unordered_map<Key, T, Hash> &&other) noexcept {
-    buckets_ = other.buckets_;
-    kvs_ = other.kvs_;
+  unordered_map(unordered_map<Key, T, Hash, Alloc> &&other) noexcept
+      : buckets_(std::move(other.buckets_)),
+        kvs_(std::move(other.kvs_)),
+        old_buckets_(rebind_t<bucket_t>(kvs_.get_allocator())) {
     size_ = other.size_;
     capacity_ = other.capacity_;
     hash_func_ = other.hash_func_;
     max_load_factor_ = other.max_load_factor_;
+    incremental_ = other.incremental_;
+    take_old_buckets_(other);
 
-    other.clear();
+    other.size_ = 0;
+    other.rebuild_(1);
   }
 
-  // destructor
-  ~unordered_map() { clear(); }
+  // destructor: the members tear themselves down, no table is rebuilt
+  ~unordered_map() = default;
 
   // assignment
   unordered_map &operator=(const unordered_map &other) {
-    buckets_ = other.buckets_;
+    if (this == &other) {
+      return *this;
+    }
     kvs_ = other.kvs_;
     size_ = other.size_;
-    capacity_ = other.capacity_;
     hash_func_ = other.hash_func_;
+    max_load_factor_ = other.max_load_factor_;
+    incremental_ = other.incremental_;
+    rebuild_(other.capacity_);
+    return *this;
   }
 
   unordered_map &operator=(unordered_map &&other) noexcept {
-    buckets_ = other.buckets_;
-    kvs_ = other.kvs_;
+    if (this == &other) {
+      return *this;
+    }
+    auto first = other.kvs_.begin();
+    kvs_ = std::move(other.kvs_);
     size_ = other.size_;
-    capacity_ = other.capacity_;
     hash_func_ = other.hash_func_;
     max_load_factor_ = other.max_load_factor_;
+    incremental_ = other.incremental_;
+    if (kvs_.empty() || kvs_.begin() == first) {
+      // the nodes were taken over, so are the buckets pointing at them
+      buckets_ = std::move(other.buckets_);
+      capacity_ = other.capacity_;
+      take_old_buckets_(other);
+    } else {
+      rebuild_(other.capacity_);
+    }
 
-    other.clear();
+    other.size_ = 0;
+    other.rebuild_(1);
+    return *this;
   }
 
+  Alloc get_allocator() const { return Alloc(kvs_.get_allocator()); }
+
   // iterator
   iterator begin() { return iterator(kvs_.begin()); }
   iterator end() { return iterator(kvs_.end()); }
@@ -152,24 +423,66 @@ class unordered_map {
    * 2. some spec is different than cpp-reference, also boring.
    **/
   void clear() noexcept {
-    buckets_.clear();
+    if (old_capacity_ != 0 && buckets_.size() < capacity_) {
+      // the new table is not built yet and holds no entry, go back to the old one, still whole
+      buckets_.swap(old_buckets_);
+      capacity_ = old_capacity_;
+    }
+    for (auto &bucket : buckets_) {
+      bucket.clear();
+    }
+    drop_old_buckets_();
     kvs_.clear();
     size_ = 0;
   }
 
-  void insert(const kv_t &value) { insert_(value); }
+  // insert value unless its key is there, returns the entry of the key and whether value was inserted
+  std::pair<iterator, bool> insert(const kv_t &value) { return try_emplace_(value.first, value.second); }
 
-  void insert(kv_t &&value) { insert_(value); }
+  std::pair<iterator, bool> insert(kv_t &&value) { return try_emplace_(value.first, std::move(value.second)); }
 
-  void erase(iterator pos) {
-    auto i = hash_(pos->first);
-    for (auto itr = buckets_[i].begin(); itr != buckets_[i].end(); itr++) {
-      if (itr.node_->val_->first == pos->first) {
-        buckets_[i].erase(itr);
-      }
+  // construct the value from args only if key is absent
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const Key &key, Args &&...args) {
+    return try_emplace_(key, std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(Key &&key, Args &&...args) {
+    return try_emplace_(std::move(key), std::forward<Args>(args)...);
+  }
+
+  // insert, or assign obj to the value of key; true if inserted
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(const Key &key, M &&obj) {
+    return insert_or_assign_(key, std::forward<M>(obj));
+  }
+
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(Key &&key, M &&obj) {
+    return insert_or_assign_(std::move(key), std::forward<M>(obj));
+  }
+
+  // construct the pair from args first, then drop it if its key is there (try_emplace does not construct anything)
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args &&...args) {
+    kvs_.emplace_back(std::forward<Args>(args)...);
+    auto itr = iterator(--kvs_.end());
+    auto h = hash_func_(itr->first);
+    auto opt = get_(itr->first, h);
+    if (opt.has_value()) {
+      kvs_.pop_back();
+      return {opt.value(), false};
     }
-    kvs_.erase(pos);
+    link_(h, itr);
+    return {itr, true};
+  }
+
+  void erase(iterator pos) {
+    unlink_from_(bucket_of_(pos.hash()), pos);
+    kvs_.erase(pos.itr_);
     size_--;
+    rehash_step_();
   }
 
   void swap(unordered_map &other) {
@@ -187,6 +500,9 @@ class unordered_map {
     auto tmp_max_load_factor = max_load_factor_;
     max_load_factor_ = other.max_load_factor_;
     other.max_load_factor_ = tmp_max_load_factor;
+    old_buckets_.swap(other.old_buckets_);
+    std::swap(old_capacity_, other.old_capacity_);
+    std::swap(incremental_, other.incremental_);
   }
 
   // observer
@@ -198,28 +514,165 @@ class unordered_map {
     return end();
   }
 
+  // reads only: safe for concurrent readers, even in the middle of an incremental rehash
+  const_iterator find(const Key &key) const {
+    std::optional<iterator> opt = get_(key);
+    if (opt.has_value()) {
+      return opt.value();
+    }
+    return end();
+  }
+
   T &at(const Key &key) {
     std::optional<iterator> opt = get_(key);
     if (opt.has_value()) {
-      return opt.value().node_->val_.second;
+      return opt.value()->second;
     }
     throw std::exception();
   }
 
-  T &operator[](const Key &key) {
+  T &operator[](const Key &key) { return try_emplace_(key).first->second; }
+
+  T &operator[](Key &&key) { return try_emplace_(std::move(key)).first->second; }
+
+  size_t count(const Key &key) { return get_(key).has_value() ? 1 : 0; }
+
+  // heterogeneous lookups (transparent Hash): e.g. string keys looked up by std::string_view, no Key is built
+  template <typename K, typename = if_transparent_t<K>>
+  iterator find(const K &key) {
     std::optional<iterator> opt = get_(key);
     if (opt.has_value()) {
-      return opt.value().node_->val_.second;
+      return opt.value();
     }
-    insert_({key, T{}});
-    return at(key);
+    return end();
   }
 
-  size_t count(const Key &key) { return get_(key).has_value() ? 1 : 0; }
+  template <typename K, typename = if_transparent_t<K>>
+  const_iterator find(const K &key) const {
+    std::optional<iterator> opt = get_(key);
+    if (opt.has_value()) {
+      return opt.value();
+    }
+    return end();
+  }
+
+  template <typename K, typename = if_transparent_t<K>>
+  T &at(const K &key) {
+    std::optional<iterator> opt = get_(key);
+    if (opt.has_value()) {
+      return opt.value()->second;
+    }
+    throw std::exception();
+  }
+
+  template <typename K, typename = if_transparent_t<K>>
+  size_t count(const K &key) {
+    return get_(key).has_value() ? 1 : 0;
+  }
+
+  // a Key is built from key only if it is absent
+  template <typename K, typename = if_transparent_t<K>>
+  T &operator[](K &&key) {
+    return try_emplace_(std::forward<K>(key)).first->second;
+  }
+
+  /**
+   * Look up the keys of [first, last) at once, writing the iterator of each (end() if absent) to out in order; returns
+   * how many were found. The keys go by batch_size: all hashed and their buckets prefetched, then the first slot of
+   * each bucket prefetched, then the entry of that slot, and only then compared. The cache misses of a batch overlap
+   * instead of stalling each find in turn. Each batch is read twice, so the keys come from forward iterators.
+   */
+  template <typename ForwardIt, typename OutputIt>
+  size_t find_batch(ForwardIt first, ForwardIt last, OutputIt out) {
+    static_assert(is_forward_iterator_v<ForwardIt>, "find_batch reads each batch twice");
+    size_t found = 0;
+    size_t hashes[batch_size];
+    bucket_t *buckets[batch_size];
+    ForwardIt keys[batch_size];
+    while (first != last) {
+      size_t n = 0;
+      for (; n < batch_size && first != last; n++, ++first) {
+        keys[n] = first;
+        hashes[n] = hash_func_(*first);
+        buckets[n] = &bucket_of_(hashes[n]);
+        __builtin_prefetch(buckets[n]);
+      }
+      for (size_t i = 0; i < n; i++) {
+        prefetch_slot_(*buckets[i]);
+      }
+      for (size_t i = 0; i < n; i++) {
+        prefetch_entry_(*buckets[i]);
+      }
+      for (size_t i = 0; i < n; i++) {
+        auto opt = get_(*keys[i], hashes[i]);
+        found += opt.has_value() ? 1 : 0;
+        *out = opt.has_value() ? opt.value() : end();
+        ++out;
+      }
+    }
+    return found;
+  }
+
+  template <typename Keys, typename OutputIt>
+  size_t find_batch(const Keys &keys, OutputIt out) {
+    return find_batch(std::begin(keys), std::end(keys), out);
+  }
 
-  // bucket API
+  /**
+   * Insert the pairs of [first, last) whose keys are absent, like insert; returns how many were inserted. Room is
+   * reserved up front, then the pairs go by batch_size as in find_batch, read twice as well.
+   */
+  template <typename ForwardIt>
+  size_t insert_batch(ForwardIt first, ForwardIt last) {
+    static_assert(is_forward_iterator_v<ForwardIt>, "insert_batch reads each batch twice");
+    auto count = size_ + std::distance(first, last);
+    if (count > max_load_factor_ * capacity_) {
+      reserve(count);
+    }
+    size_t inserted = 0;
+    size_t hashes[batch_size];
+    bucket_t *buckets[batch_size];
+    while (first != last) {
+      auto batch = first;
+      size_t n = 0;
+      for (; n < batch_size && first != last; n++, ++first) {
+        hashes[n] = hash_func_((*first).first);
+        buckets[n] = &bucket_of_(hashes[n]);
+        __builtin_prefetch(buckets[n]);
+      }
+      for (size_t i = 0; i < n; i++) {
+        prefetch_slot_(*buckets[i]);
+      }
+      for (size_t i = 0; i < n; i++) {
+        prefetch_entry_(*buckets[i]);
+      }
+      for (size_t i = 0; i < n; i++, ++batch) {
+        inserted += try_emplace_hashed_(hashes[i], (*batch).first, (*batch).second).second ? 1 : 0;
+      }
+    }
+    return inserted;
+  }
+
+  template <typename Range>
+  size_t insert_batch(const Range &range) {
+    return insert_batch(std::begin(range), std::end(range));
+  }
+
+  // bucket API, on the new table while an incremental rehash is in progress
   size_t bucket(const Key &key) const { return hash_(key); }
-  size_t bucket_size(size_t n) const { return buckets_[n].size(); }
+
+  // the entries of bucket n, including those still waiting in the old table during an incremental rehash
+  size_t bucket_size(size_t n) const {
+    auto count = n < buckets_.size() ? buckets_[n].size() : 0;
+    if (old_capacity_ != 0 && n % old_capacity_ < old_buckets_.size()) {
+      // the new table is twice as large: bucket n only takes entries of the old bucket n % old_capacity_
+      auto &old = old_buckets_[n % old_capacity_];
+      for (auto itr = old.begin(); itr != old.end(); itr++) {
+        count += itr->hash_ % capacity_ == n ? 1 : 0;
+      }
+    }
+    return count;
+  }
   size_t bucket_count() const { return capacity_; }
 
   // hash strategy
@@ -229,23 +682,75 @@ class unordered_map {
 
   void rehash(size_t count) { rehash_(count); }
 
+  /**
+   * Incremental mode: when the load factor is exceeded, the table is not rebuilt by the insert that crossed it.
+   * A table twice as large is allocated but not constructed, each following insert/erase constructs or migrates
+   * rehash_step of its buckets, and the old buckets are destroyed as they are migrated: no operation touches more
+   * than rehash_step buckets. Each key is looked up in the one table holding it. rehash() and reserve() still
+   * rebuild at once.
+   */
+  void incremental_rehash(bool enable) { incremental_ = enable; }
+  bool incremental_rehash() const { return incremental_; }
+  bool rehashing() const { return old_capacity_ != 0; }
+
   void reserve(size_t count) { rehash(std::ceil(count / max_load_factor())); }
 
-  std::hash<T> hash_function() const { return hash_func_; }
+  Hash hash_function() const { return hash_func_; }
+
+ private:
+  template <typename K, typename M>
+  std::pair<iterator, bool> insert_or_assign_(K &&key, M &&obj) {
+    // try_emplace_ consumes obj only when it inserts
+    auto result = try_emplace_(std::forward<K>(key), std::forward<M>(obj));
+    if (!result.second) {
+      result.first->second = std::forward<M>(obj);
+    }
+    return result;
+  }
+
+  // prefetch the first slot of bucket, once bucket itself is in cache
+  static void prefetch_slot_(bucket_t &bucket) {
+    auto itr = bucket.begin();
+    if (itr != bucket.end()) {
+      __builtin_prefetch(&*itr);
+    }
+  }
+
+  // prefetch the entry of the first slot of bucket, once the slot is in cache
+  static void prefetch_entry_(bucket_t &bucket) {
+    auto itr = bucket.begin();
+    if (itr != bucket.end()) {
+      __builtin_prefetch(&*itr->itr_);
+    }
+  }
+
+  // take the incremental rehash state of other, whose buckets_ were taken as well
+  void take_old_buckets_(unordered_map &other) {
+    old_buckets_ = std::move(other.old_buckets_);
+    old_capacity_ = other.old_capacity_;
+    other.old_capacity_ = 0;
+  }
+
+ public:
 
   // debug
   void view() {
 #ifdef DEBUG
-    std::cout << "unordered_map => sz(" << size_ << ") cap(" << capacity_ << ")" << std::endl;
-    for (auto i = 0; i < capacity_; i++) {
+    std::cout << "unordered_map => sz(" << size_ << ") cap(" << capacity_ << ")";
+    if (old_capacity_ != 0) {
+      std::cout << " rehashing(" << buckets_.size() << "/" << capacity_ << " built, "
+                << old_capacity_ - old_buckets_.size() << "/" << old_capacity_ << " migrated)";
+    }
+    std::cout << std::endl;
+    for (size_t i = 0; i < buckets_.size(); i++) {
       std::cout << "\tbucket[" << i << "] : [";
       if (!buckets_[i].empty()) {
         auto end = buckets_[i].end();
         end--;
         for (auto itr = buckets_[i].begin(); itr != end; itr++) {
-          std::cout << "(" << itr->node_->val_.first << "," << itr->node_->val_.second << "), ";
+          std::cout << "(" << itr->itr_->first << "," << itr->itr_->second << "), ";
         }
-        std::cout << "(" << end->node_->val_.first << "," << end->node_->val_.second << ")";
+        std::cout << "(" << end->itr_->first << "," << end->itr_->second << ")";
       }
       std::cout << "]" << std::endl;
     }
@@ -0,0 +1,409 @@
+#pragma once
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "relocate.h"
+
+#define DEBUG
+
+namespace STL {
+
+/**
+ * A doubly linked list of blocks holding up to K elements each, with the interface of list.
+ *
+ * @details
+ * Walking it touches one block per K elements instead of one node per element, and costs two pointers per block
+ * instead of two per element. The price: insert and erase move up to K elements inside their block, and invalidate
+ * the iterators into that block (and into the block it is split into or merged with).
+ * <ul>
+ * <li>insert into a full block splits it in two halves.</li>
+ * <li>erase merges a block that became less than half full with its successor when they fit in one block.</li>
+ * </ul>
+ */
+template <typename T, size_t K = (sizeof(T) < 64 ? 256 / sizeof(T) : 4), typename Alloc = std::allocator<T>>
+class unrolled_list {
+  static_assert(K > 0, "a block holds at least one element");
+
+ public:
+  struct block_base {
+    block_base *prev_{nullptr};
+    block_base *next_{nullptr};
+    size_t size_{0};  // number of elements, 0 for the sentinel
+  };
+
+  struct block : block_base {
+    alignas(T) unsigned char buf_[K * sizeof(T)];
+
+    T *data() { return reinterpret_cast<T *>(buf_); }
+  };
+
+  class Iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T *;
+    using reference = T &;
+
+    block_base *block_{nullptr};
+    size_t idx_{0};
+
+   public:
+    Iterator() = default;
+    Iterator(block_base *block, size_t idx) : block_(block), idx_(idx) {}
+
+    T &operator*() const { return static_cast<block *>(block_)->data()[idx_]; }
+    T *operator->() const { return &**this; }
+    // ++itr
+    Iterator &operator++() {
+      if (++idx_ >= block_->size_) {
+        block_ = block_->next_;
+        idx_ = 0;
+      }
+      return *this;
+    }
+    // itr++
+    Iterator operator++(int) {
+      auto old = *this;
+      ++*this;
+      return old;
+    }
+    // --itr
+    Iterator &operator--() {
+      if (idx_ == 0) {
+        block_ = block_->prev_;
+        idx_ = block_->size_;
+      }
+      idx_--;
+      return *this;
+    }
+    // itr--
+    Iterator operator--(int) {
+      auto old = *this;
+      --*this;
+      return old;
+    }
+
+    bool operator==(const Iterator &other) const { return block_ == other.block_ && idx_ == other.idx_; }
+    bool operator!=(const Iterator &other) const { return !(*this == other); }
+  };
+
+  using iterator = Iterator;
+  using const_iterator = const Iterator;
+  using value_type = T;
+  using allocator_type = Alloc;
+
+ private:
+  using block_alloc_t = typename std::allocator_traits<Alloc>::template rebind_alloc<block>;
+  using block_traits = std::allocator_traits<block_alloc_t>;
+
+  block_alloc_t alloc_{};  // where blocks come from
+  block_base sentinel_;    // circular: its next_ is the first block, its prev_ the last one
+  size_t size_{0};         // number of elements
+
+  block_base *end_() const { return const_cast<block_base *>(&sentinel_); }
+  static block *as_block_(block_base *b) { return static_cast<block *>(b); }
+
+  void init_() {
+    sentinel_.next_ = end_();
+    sentinel_.prev_ = end_();
+  }
+
+  // a new empty block linked before next
+  block *new_block_(block_base *next) {
+    auto b = block_traits::allocate(alloc_, 1);
+    ::new (static_cast<void *>(b)) block();
+    b->next_ = next;
+    b->prev_ = next->prev_;
+    next->prev_->next_ = b;
+    next->prev_ = b;
+    return b;
+  }
+
+  // unlink and free an empty block
+  void delete_block_(block_base *b) {
+    b->prev_->next_ = b->next_;
+    b->next_->prev_ = b->prev_;
+    as_block_(b)->~block();
+    block_traits::deallocate(alloc_, as_block_(b), 1);
+  }
+
+  static void destroy_(block_base *b) {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      auto data = as_block_(b)->data();
+      for (size_t i = 0; i < b->size_; i++) {
+        data[i].~T();
+      }
+    }
+    b->size_ = 0;
+  }
+
+  // move the upper half of the full block b into a new block after it
+  block *split_(block *b) {
+    auto upper = new_block_(b->next_);
+    auto half = K / 2;
+    relocate(upper->data(), b->data() + half, K - half);
+    upper->size_ = K - half;
+    b->size_ = half;
+    return upper;
+  }
+
+  // construct an element at pos, returns where it ended up
+  template <typename... Args>
+  iterator emplace_(iterator pos, Args &&...args) {
+    auto b = pos.block_;
+    auto idx = pos.idx_;
+    if (b == end_()) {
+      // append to the last block
+      b = sentinel_.prev_;
+      if (b == end_() || b->size_ == K) {
+        b = new_block_(end_());
+      }
+      idx = b->size_;
+    } else if (b->size_ == K) {
+      if (idx == 0 && b->prev_ != end_() && b->prev_->size_ < K) {
+        // append to the previous block instead
+        b = b->prev_;
+        idx = b->size_;
+      } else {
+        auto upper = split_(as_block_(b));
+        if (idx > b->size_) {
+          idx -= b->size_;
+          b = upper;
+        }
+      }
+    }
+    auto data = as_block_(b)->data();
+    try {
+      if (idx == b->size_) {
+        ::new (static_cast<void *>(data + idx)) T(std::forward<Args>(args)...);
+      } else {
+        // args may refer to an element that is about to be shifted
+        T tmp(std::forward<Args>(args)...);
+        relocate(data + idx + 1, data + idx, b->size_ - idx);
+        try {
+          ::new (static_cast<void *>(data + idx)) T(std::move(tmp));
+        } catch (...) {
+          relocate(data + idx, data + idx + 1, b->size_ - idx);
+          throw;
+        }
+      }
+    } catch (...) {
+      if (b->size_ == 0) {
+        // the block was linked for this element, no empty block may stay in the chain
+        delete_block_(b);
+      }
+      throw;
+    }
+    b->size_++;
+    size_++;
+    return iterator(b, idx);
+  }
+
+  // merge the successor of b into b when both fit in one block
+  void merge_next_(block_base *b) {
+    auto next = b->next_;
+    if (next == end_() || b->size_ + next->size_ > K) {
+      return;
+    }
+    relocate(as_block_(b)->data() + b->size_, as_block_(next)->data(), next->size_);
+    b->size_ += next->size_;
+    next->size_ = 0;
+    delete_block_(next);
+  }
+
+  void copy_from_(const unrolled_list &other) {
+    for (auto itr = other.begin(); itr != other.end(); ++itr) {
+      emplace_(end(), *itr);
+    }
+  }
+
+ public:
+  // constructor
+  unrolled_list() { init_(); }
+
+  explicit unrolled_list(const Alloc &alloc) : alloc_(alloc) { init_(); }
+
+  unrolled_list(std::initializer_list<T> init, const Alloc &alloc = Alloc()) : alloc_(alloc) {
+    init_();
+    for (auto &value : init) {
+      emplace_(end(), value);
+    }
+  }
+
+  unrolled_list(const unrolled_list &other)
+      : alloc_(block_traits::select_on_container_copy_construction(other.alloc_)) {
+    init_();
+    copy_from_(other);
+  }
+
+  unrolled_list(unrolled_list &&other) noexcept : alloc_(std::move(other.alloc_)) {
+    init_();
+    swap_blocks_(other);
+  }
+
+  // destructor
+  ~unrolled_list() { clear(); }
+
+  unrolled_list &operator=(const unrolled_list &other) {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    if constexpr (block_traits::propagate_on_container_copy_assignment::value) {
+      alloc_ = other.alloc_;
+    }
+    copy_from_(other);
+    return *this;
+  }
+
+  unrolled_list &operator=(unrolled_list &&other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    if constexpr (block_traits::propagate_on_container_move_assignment::value) {
+      alloc_ = std::move(other.alloc_);
+    } else if (alloc_ != other.alloc_) {
+      // other's blocks cannot be released by alloc_, move the elements instead
+      for (auto itr = other.begin(); itr != other.end(); ++itr) {
+        emplace_(end(), std::move(*itr));
+      }
+      other.clear();
+      return *this;
+    }
+    swap_blocks_(other);
+    return *this;
+  }
+
+  Alloc get_allocator() const { return Alloc(alloc_); }
+
+  // iterator
+  iterator begin() { return iterator(sentinel_.next_, 0); }
+  iterator end() { return iterator(end_(), 0); }
+  const_iterator begin() const { return iterator(sentinel_.next_, 0); }
+  const_iterator end() const { return iterator(end_(), 0); }
+
+  // capacity
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+  static constexpr size_t block_capacity() { return K; }
+
+  // modifier
+  void push_back(const T &value) { emplace_(end(), value); }
+  void push_back(T &&value) { emplace_(end(), std::move(value)); }
+
+  void pop_back() {
+    if (size_ == 0) {
+      throw std::exception();
+    }
+    erase(iterator(sentinel_.prev_, sentinel_.prev_->size_ - 1));
+  }
+
+  void push_front(const T &value) { emplace_(begin(), value); }
+  void push_front(T &&value) { emplace_(begin(), std::move(value)); }
+
+  void pop_front() {
+    if (size_ == 0) {
+      throw std::exception();
+    }
+    erase(begin());
+  }
+
+  void clear() {
+    auto curr = sentinel_.next_;
+    while (curr != end_()) {
+      auto next = curr->next_;
+      destroy_(curr);
+      delete_block_(curr);
+      curr = next;
+    }
+    size_ = 0;
+  }
+
+  // returns the iterator following the erased element
+  iterator erase(iterator pos) {
+    auto b = pos.block_;
+    auto idx = pos.idx_;
+    auto data = as_block_(b)->data();
+    data[idx].~T();
+    relocate(data + idx, data + idx + 1, b->size_ - idx - 1);
+    b->size_--;
+    size_--;
+    if (b->size_ == 0) {
+      auto next = b->next_;
+      delete_block_(b);
+      return iterator(next, 0);
+    }
+    if (b->size_ < K / 2) {
+      merge_next_(b);
+    }
+    return idx < b->size_ ? iterator(b, idx) : iterator(b->next_, 0);
+  }
+
+  // returns the iterator to the inserted element
+  iterator insert(iterator pos, const T &value) { return emplace_(pos, value); }
+  iterator insert(iterator pos, T &&value) { return emplace_(pos, std::move(value)); }
+
+  void swap(unrolled_list &other) {
+    swap_blocks_(other);
+    if constexpr (block_traits::propagate_on_container_swap::value) {
+      std::swap(alloc_, other.alloc_);
+    }
+  }
+
+  // operator
+  bool operator==(const unrolled_list &other) const {
+    if (size_ != other.size_) {
+      return false;
+    }
+    auto itr2 = other.begin();
+    for (auto itr1 = begin(); itr1 != end(); ++itr1, ++itr2) {
+      if (*itr1 != *itr2) {
+        return false;
+      }
+    }
+    return true;
+  }
+  bool operator!=(const unrolled_list &other) const { return !(*this == other); }
+
+  void view() {
+#ifdef DEBUG
+    std::cout << "unrolled_list<" << K << "> => sz(" << size_ << ") : [";
+    for (auto b = sentinel_.next_; b != end_(); b = b->next_) {
+      std::cout << "[";
+      for (size_t i = 0; i < b->size_; i++) {
+        std::cout << (i == 0 ? "" : ",") << as_block_(b)->data()[i];
+      }
+      std::cout << "]";
+    }
+    std::cout << "]" << std::endl;
+#endif
+  }
+
+ private:
+  // exchange the chains of blocks, the sentinels stay where they are
+  void swap_blocks_(unrolled_list &other) {
+    std::swap(sentinel_.next_, other.sentinel_.next_);
+    std::swap(sentinel_.prev_, other.sentinel_.prev_);
+    std::swap(size_, other.size_);
+    relink_();
+    other.relink_();
+  }
+
+  void relink_() {
+    if (size_ == 0) {
+      init_();
+      return;
+    }
+    sentinel_.next_->prev_ = end_();
+    sentinel_.prev_->next_ = end_();
+  }
+};
+
+}  // namespace STL
@@ -1,46 +1,153 @@
 #pragma once
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#include "parallel.h"
+#include "relocate.h"
+#include "simd.h"
 
 #define DEBUG
 
 namespace STL {
-template <typename T>
-class vector {
+
+/**
+ * Growth policies of vector: grow(capacity, required, elem_size) returns the capacity of the next
+ * expansion, which is never less than required.
+ */
+namespace growth {
+
+/* new capacity = 2 * capacity */
+struct doubling {
+  static size_t grow(size_t capacity, size_t required, size_t /* elem_size */) {
+    return std::max(required, capacity == 0 ? 1 : capacity * 2);
+  }
+};
+
+/* new capacity = 1.5 * capacity, the sum of freed blocks soon exceeds the next request and can be reused */
+struct one_and_half {
+  static size_t grow(size_t capacity, size_t required, size_t /* elem_size */) {
+    return std::max(required, capacity + (capacity + 1) / 2);
+  }
+};
+
+/* grow as Base, then round buffers of at least one page up to a whole number of pages */
+template <size_t PageSize = 4096, typename Base = doubling>
+struct page_rounded {
+  static size_t grow(size_t capacity, size_t required, size_t elem_size) {
+    auto bytes = Base::grow(capacity, required, elem_size) * elem_size;
+    if (bytes >= PageSize) {
+      bytes = (bytes + PageSize - 1) / PageSize * PageSize;
+    }
+    return bytes / elem_size;
+  }
+};
+
+/* page_rounded on 2MiB transparent hugepages */
+template <typename Base = doubling>
+using hugepage_rounded = page_rounded<2 * 1024 * 1024, Base>;
+
+}  // namespace growth
+
+/* It is usable as an input iterator: pointers, STL::list iterators, std:: iterators... */
+template <typename It, typename = void>
+struct is_input_iterator : std::false_type {};
+
+template <typename It>
+struct is_input_iterator<It, std::void_t<typename std::iterator_traits<It>::iterator_category>>
+    : std::is_convertible<typename std::iterator_traits<It>::iterator_category, std::input_iterator_tag> {};
+
+template <typename It>
+inline constexpr bool is_input_iterator_v = is_input_iterator<It>::value;
+
+/* It can be traversed twice, so the length of a range is known before copying it */
+template <typename It>
+inline constexpr bool is_forward_iterator_v =
+    std::is_convertible_v<typename std::iterator_traits<It>::iterator_category, std::forward_iterator_tag>;
+
+namespace telemetry {
+
+/* the default Telemetry of vector: records nothing and, as an empty base, takes no room; see telemetry.h for on */
+struct off {
+  template <typename C>
+  struct probe {
+    explicit probe(const C * /* owner */) {}
+    void reallocated(size_t /* bytes_copied */) {}
+  };
+};
+
+}  // namespace telemetry
+
+template <typename T, typename Growth = growth::doubling, typename Alloc = std::allocator<T>,
+          typename Telemetry = telemetry::off>
+class vector : private Telemetry::template probe<vector<T, Growth, Alloc, Telemetry>> {
  private:
-  T *arr_{nullptr};     // the dynamic array
+  using alloc_traits = std::allocator_traits<Alloc>;
+  using probe_t = typename Telemetry::template probe<vector>;
+
+  Alloc alloc_{};       // where arr_ comes from
+  T *arr_{nullptr};     // the dynamic array, only [0, size_) is constructed
   size_t size_{0};      // size of used memory/sizeof(T)
   size_t capacity_{0};  // size of occupied memory/sizeof(T)
 
-  void copy_(T *dst, T *src, size_t size) {
-    auto tmp = new T[size];
-    for (auto i = 0; i < size; i++) {
-      tmp[i] = src[i];
+  /* raw storage: allocate/free memory without constructing any T */
+  T *allocate_(size_t size) { return size == 0 ? nullptr : alloc_traits::allocate(alloc_, size); }
+  void deallocate_(T *arr, size_t size) {
+    if (arr != nullptr) {
+      alloc_traits::deallocate(alloc_, arr, size);
     }
-    for (auto i = 0; i < size; i++) {
-      dst[i] = tmp[i];
+  }
+
+  static void destroy_(T *first, T *last) {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      for (; first != last; first++) {
+        first->~T();
+      }
     }
-    delete[] tmp;
   }
 
-  /* dynamic expansion */
-  void resize_(bool force = false);
+  /* telemetry hook, called whenever the buffer is replaced, moved is the number of elements carried over */
+  void reallocated_(size_t moved) { probe_t::reallocated(moved * sizeof(T)); }
+
+  /* reallocate to exactly new_cap, existing elements are relocated */
+  void realloc_(size_t new_cap);
+
+  /* reallocate to exactly new_cap and construct a new element at idx in the new storage */
+  template <typename... Args>
+  void realloc_insert_(size_t idx, size_t new_cap, Args &&...args);
+
+  /* open a gap of size elements at idx with at most one reallocation, fill(dst) constructs them at dst (or none) */
+  template <typename Fill>
+  void insert_n_(size_t idx, size_t size, Fill fill);
+
+  /* capacity after the next expansion, at least required */
+  size_t next_capacity_(size_t required) const noexcept { return Growth::grow(capacity_, required, sizeof(T)); }
+
+  /* dynamic expansion: make room for required elements with at most one reallocation */
+  void resize_(size_t required);
 
  public:
   using iterator = T *;              // random iterator
   using const_iterator = const T *;  // constant iterator
+  using value_type = T;
+  using allocator_type = Alloc;
 
  public:
   // constructors
   vector();
+  explicit vector(const Alloc &alloc);
   vector(T *arr, size_t size);
   vector(T *first, T *last);
   explicit vector(size_t size);
   vector(size_t size, const T &value);
-  vector(vector<T> &&other) noexcept;
-  vector(const vector<T> &other);
+  vector(vector<T, Growth, Alloc, Telemetry> &&other) noexcept;
+  vector(const vector<T, Growth, Alloc, Telemetry> &other);
   vector(std::initializer_list<T> init);
 
   // destructor
@@ -54,20 +161,33 @@ class vector {
 
   // modifier
   void push_back(const T &value);
+  void push_back(T &&value);
+  template <typename... Args>
+  T &emplace_back(Args &&...args);
   void pop_back();
   void clear();
 
   void erase(iterator pos);
-  void erase(vector<T>::iterator first, vector<T>::iterator last);
+  void erase(vector<T, Growth, Alloc, Telemetry>::iterator first, vector<T, Growth, Alloc, Telemetry>::iterator last);
+
+  template <typename... Args>
+  iterator emplace(vector<T, Growth, Alloc, Telemetry>::iterator pos, Args &&...args);
 
-  void insert(vector<T>::iterator pos, const T &value);
-  void insert(vector<T>::iterator pos, size_t size, const T &value);
-  void insert(vector<T>::iterator pos, vector<T>::iterator first, vector<T>::iterator last);
+  void insert(vector<T, Growth, Alloc, Telemetry>::iterator pos, const T &value);
+  void insert(vector<T, Growth, Alloc, Telemetry>::iterator pos, size_t size, const T &value);
+  template <typename InputIt, typename = std::enable_if_t<is_input_iterator_v<InputIt>>>
+  void insert(vector<T, Growth, Alloc, Telemetry>::iterator pos, InputIt first, InputIt last);
+  template <typename InputIt, typename = std::enable_if_t<is_input_iterator_v<InputIt>>>
+  void append(InputIt first, InputIt last);
+  template <typename InputIt, typename = std::enable_if_t<is_input_iterator_v<InputIt>>>
+  void assign(InputIt first, InputIt last);
 
   void resize(size_t size);
   void resize(size_t size, T value);
 
-  void swap(vector<T> &other);
+  void swap(vector<T, Growth, Alloc, Telemetry> &other);
+
+  Alloc get_allocator() const;
 
   // capacity
   bool empty() const noexcept;
@@ -76,14 +196,24 @@ class vector {
   size_t capacity() const noexcept;
   T *data();
   void reserve(size_t new_cap);
+  void shrink_to_fit();
+
+  // search, vectorized for arithmetic T
+  iterator find(const T &value);
+  const_iterator find(const T &value) const;
+  size_t count(const T &value) const;
+  bool contains(const T &value) const;
+  iterator min_element();
+  iterator max_element();
 
   // operator
   T &operator[](size_t pos);
   const T &operator[](size_t pos) const;
-  constexpr vector<T> &operator=(const vector<T> &other);
-  constexpr vector<T> &operator=(vector<T> &&other) noexcept;
-  bool operator==(const vector<T> &other);
-  bool operator!=(const vector<T> &other);
+  vector<T, Growth, Alloc, Telemetry> &operator=(const vector<T, Growth, Alloc, Telemetry> &other);
+  constexpr vector<T, Growth, Alloc, Telemetry> &operator=(vector<T, Growth, Alloc, Telemetry> &&other) noexcept(
+      alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value);
+  bool operator==(const vector<T, Growth, Alloc, Telemetry> &other);
+  bool operator!=(const vector<T, Growth, Alloc, Telemetry> &other);
 
   // debug helper
   void view() {
@@ -101,257 +231,402 @@ class vector {
   };
 };
 
-template <typename T>
-void vector<T>::resize_(bool force) {
-  /* if v.elements_num == capacity, new capacity = 2 * capacity ; */
-  if (capacity_ == 0) {
-    capacity_ = 1;
-    arr_ = new T[1];
-    return;
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+void vector<T, Growth, Alloc, Telemetry>::realloc_(size_t new_cap) {
+  auto new_arr = allocate_(new_cap);
+  reallocated_(size_);
+  relocate(new_arr, arr_, size_);
+  deallocate_(arr_, capacity_);
+  arr_ = new_arr;
+  capacity_ = new_cap;
+}
+
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+template <typename... Args>
+void vector<T, Growth, Alloc, Telemetry>::realloc_insert_(size_t idx, size_t new_cap, Args &&...args) {
+  auto new_arr = allocate_(new_cap);
+  // construct first: args may refer to elements of the old storage
+  try {
+    ::new (static_cast<void *>(new_arr + idx)) T(std::forward<Args>(args)...);
+  } catch (...) {
+    deallocate_(new_arr, new_cap);
+    throw;
   }
-  if (force || size() == capacity()) {
-    auto new_arr = new T[capacity() * 2];
-    copy_(new_arr, arr_, size());
-    delete[] arr_;
+  reallocated_(size_);
+  relocate(new_arr, arr_, idx);
+  relocate(new_arr + idx + 1, arr_ + idx, size_ - idx);
+  deallocate_(arr_, capacity_);
+  arr_ = new_arr;
+  capacity_ = new_cap;
+  size_++;
+}
+
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+template <typename Fill>
+void vector<T, Growth, Alloc, Telemetry>::insert_n_(size_t idx, size_t size, Fill fill) {
+  if (size_ + size > capacity_) {
+    auto new_cap = next_capacity_(size_ + size);
+    auto new_arr = allocate_(new_cap);
+    // fill first: the sources may be elements of the old storage
+    try {
+      fill(new_arr + idx);
+    } catch (...) {
+      deallocate_(new_arr, new_cap);
+      throw;
+    }
+    reallocated_(size_);
+    relocate(new_arr, arr_, idx);
+    relocate(new_arr + idx + size, arr_ + idx, size_ - idx);
+    deallocate_(arr_, capacity_);
     arr_ = new_arr;
-    capacity_ = capacity() * 2;
+    capacity_ = new_cap;
+  } else {
+    relocate(arr_ + idx + size, arr_ + idx, size_ - idx);
+    try {
+      fill(arr_ + idx);
+    } catch (...) {
+      // fill constructs all or nothing, close the gap again
+      relocate(arr_ + idx, arr_ + idx + size, size_ - idx);
+      throw;
+    }
+  }
+  size_ += size;
+}
+
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+void vector<T, Growth, Alloc, Telemetry>::resize_(size_t required) {
+  if (required > capacity_) {
+    realloc_(next_capacity_(required));
   }
 }
 
-template <typename T>
-vector<T>::vector() : size_(0), capacity_(0) {}
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+vector<T, Growth, Alloc, Telemetry>::vector() : probe_t(this), size_(0), capacity_(0) {}
 
-template <typename T>
-vector<T>::vector(T *arr, size_t size) : arr_(arr), size_(size), capacity_(size) {
-  resize_();  // reverse space
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+vector<T, Growth, Alloc, Telemetry>::vector(const Alloc &alloc) : probe_t(this), alloc_(alloc) {}
+
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+vector<T, Growth, Alloc, Telemetry>::vector(T *arr, size_t size)
+    : probe_t(this), arr_(allocate_(size * 2)), size_(size), capacity_(size * 2) {
+  // copy [arr, arr + size) and reserve space, the caller keeps ownership of arr
+  parallel::uninitialized_copy(arr, size, arr_);
 }
-template <typename T>
-vector<T>::vector(T *first, T *last) {
+
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+vector<T, Growth, Alloc, Telemetry>::vector(T *first, T *last) : probe_t(this) {
   // [first, last)
   if (last > first) {
-    auto size = last - first;
-    arr_ = new T[size];
+    auto size = static_cast<size_t>(last - first);
+    arr_ = allocate_(size * 2);
     size_ = size;
-    capacity_ = size;
-    copy_(arr_, first, size);
-    resize_();
+    capacity_ = size * 2;
+    parallel::uninitialized_copy(first, size, arr_);
   } else {
     throw std::exception();
   }
 }
 
-template <typename T>
-vector<T>::vector(size_t size) : arr_(new T[size]), size_(0), capacity_(size) {}
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+vector<T, Growth, Alloc, Telemetry>::vector(size_t size)
+    : probe_t(this), arr_(allocate_(size)), size_(0), capacity_(size) {}
 
-template <typename T>
-vector<T>::vector(size_t size, const T &value) : arr_(new T[size]), size_(size), capacity_(size) {
-  for (size_t i = 0; i < size; i++) {
-    arr_[i] = value;
-  }
-  resize_();
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+vector<T, Growth, Alloc, Telemetry>::vector(size_t size, const T &value)
+    : probe_t(this), arr_(allocate_(size * 2)), size_(size), capacity_(size * 2) {
+  parallel::uninitialized_fill_n(arr_, size, value);
 }
 
-template <typename T>
-vector<T>::vector(vector<T> &&other) noexcept {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+vector<T, Growth, Alloc, Telemetry>::vector(vector<T, Growth, Alloc, Telemetry> &&other) noexcept
+    : probe_t(this), alloc_(std::move(other.alloc_)) {
   // move to current
   arr_ = other.arr_;
   capacity_ = other.capacity();
   size_ = other.size();
-  resize_();
   other.arr_ = nullptr;
+  other.size_ = 0;
+  other.capacity_ = 0;
 }
 
-template <typename T>
-vector<T>::vector(const vector<T> &other) {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+vector<T, Growth, Alloc, Telemetry>::vector(const vector<T, Growth, Alloc, Telemetry> &other)
+    : probe_t(this), alloc_(alloc_traits::select_on_container_copy_construction(other.alloc_)) {
   // copy to current
-  arr_ = new T[other.size()];
+  arr_ = allocate_(other.capacity());
   capacity_ = other.capacity();
   size_ = other.size();
-  resize_();
-  copy_(arr_, other.arr_, other.size_);
+  parallel::uninitialized_copy(other.arr_, other.size_, arr_);
 }
 
-template <typename T>
-vector<T>::vector(std::initializer_list<T> init) {
-  arr_ = new T[init.size() * 2];
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+vector<T, Growth, Alloc, Telemetry>::vector(std::initializer_list<T> init) : probe_t(this) {
+  arr_ = allocate_(init.size() * 2);
   size_ = init.size();
   capacity_ = init.size() * 2;
-  auto i = 0;
-  for (auto itr = init.begin(); itr != init.end(); itr++) {
-    arr_[i++] = *itr;
-  }
+  parallel::uninitialized_copy(init.begin(), init.size(), arr_);
 }
-template <typename T>
-vector<T>::~vector() {
-  delete[] arr_;
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+vector<T, Growth, Alloc, Telemetry>::~vector() {
+  destroy_(begin(), end());
+  deallocate_(arr_, capacity_);
   arr_ = nullptr;
   size_ = 0;
   capacity_ = 0;
 }
 
-template <typename T>
-bool vector<T>::empty() const noexcept {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+Alloc vector<T, Growth, Alloc, Telemetry>::get_allocator() const {
+  return alloc_;
+}
+
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+bool vector<T, Growth, Alloc, Telemetry>::empty() const noexcept {
   return size_ == 0;
 }
 
-template <typename T>
-size_t vector<T>::size() const noexcept {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+size_t vector<T, Growth, Alloc, Telemetry>::size() const noexcept {
   return size_;
 }
 
-template <typename T>
-size_t vector<T>::capacity() const noexcept {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+size_t vector<T, Growth, Alloc, Telemetry>::capacity() const noexcept {
   return capacity_;
 }
 
-template <typename T>
-size_t vector<T>::max_size() const noexcept {
-  return capacity_ - size_;
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+size_t vector<T, Growth, Alloc, Telemetry>::max_size() const noexcept {
+  return alloc_traits::max_size(alloc_);
 }
 
-template <typename T>
-T *vector<T>::data() {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+T *vector<T, Growth, Alloc, Telemetry>::data() {
   return arr_;
 }
 
-template <typename T>
-typename vector<T>::iterator vector<T>::begin() {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+typename vector<T, Growth, Alloc, Telemetry>::iterator vector<T, Growth, Alloc, Telemetry>::begin() {
   return arr_;
 }
 
-template <typename T>
-typename vector<T>::iterator vector<T>::end() {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+typename vector<T, Growth, Alloc, Telemetry>::iterator vector<T, Growth, Alloc, Telemetry>::end() {
   return arr_ + size_;
 }
 
-template <typename T>
-typename vector<T>::const_iterator vector<T>::begin() const {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+typename vector<T, Growth, Alloc, Telemetry>::const_iterator vector<T, Growth, Alloc, Telemetry>::begin() const {
   return arr_;
 }
 
-template <typename T>
-typename vector<T>::const_iterator vector<T>::end() const {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+typename vector<T, Growth, Alloc, Telemetry>::const_iterator vector<T, Growth, Alloc, Telemetry>::end() const {
   return arr_ + size_;
 }
 
-template <typename T>
-void vector<T>::push_back(const T &value) {
-  resize_();
-  arr_[size_++] = value;
-  resize_();
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+void vector<T, Growth, Alloc, Telemetry>::push_back(const T &value) {
+  emplace_back(value);
+}
+
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+void vector<T, Growth, Alloc, Telemetry>::push_back(T &&value) {
+  emplace_back(std::move(value));
 }
 
-template <typename T>
-void vector<T>::pop_back() {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+template <typename... Args>
+T &vector<T, Growth, Alloc, Telemetry>::emplace_back(Args &&...args) {
+  if (size_ == capacity_) {
+    realloc_insert_(size_, next_capacity_(size_ + 1), std::forward<Args>(args)...);
+  } else {
+    ::new (static_cast<void *>(arr_ + size_)) T(std::forward<Args>(args)...);
+    size_++;
+  }
+  return arr_[size_ - 1];
+}
+
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+void vector<T, Growth, Alloc, Telemetry>::pop_back() {
   size_--;
+  arr_[size_].~T();
 }
 
-template <typename T>
-void vector<T>::clear() {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+void vector<T, Growth, Alloc, Telemetry>::clear() {
+  destroy_(begin(), end());
   size_ = 0;
 }
 
-template <typename T>
-void vector<T>::erase(vector::iterator pos) {
-  for (auto itr = begin(); itr != end(); itr++) {
-    if (pos == itr) {
-      copy_(pos, pos + 1, end() - itr);
-      size_--;
-      break;
-    }
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+void vector<T, Growth, Alloc, Telemetry>::erase(vector::iterator pos) {
+  if (pos < begin() || pos >= end()) {
+    return;
   }
+  pos->~T();
+  relocate(pos, pos + 1, end() - pos - 1);
+  size_--;
 }
 
-template <typename T>
-void vector<T>::erase(vector::iterator first, vector::iterator last) {
-  for (auto itr = begin(); itr != end(); itr++) {
-    if (first == itr) {
-      if (last > end()) {
-        last = end();
-      }
-      copy_(first, last, end() - itr);
-      size_ -= (last - first);
-      break;
-    }
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+void vector<T, Growth, Alloc, Telemetry>::erase(vector::iterator first, vector::iterator last) {
+  if (first < begin() || first >= end()) {
+    return;
+  }
+  if (last > end()) {
+    last = end();
   }
+  destroy_(first, last);
+  relocate(first, last, end() - last);
+  size_ -= (last - first);
 }
 
-template <typename T>
-void vector<T>::insert(vector::iterator pos, const T &value) {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+template <typename... Args>
+typename vector<T, Growth, Alloc, Telemetry>::iterator vector<T, Growth, Alloc, Telemetry>::emplace(
+    vector::iterator pos, Args &&...args) {
   if (pos < begin() || pos > end()) {
     throw std::exception();
   }
-  auto idx = pos - begin();
-  while (max_size() < 1) {
-    resize_(true);
+  auto idx = static_cast<size_t>(pos - begin());
+  if (size_ == capacity_) {
+    realloc_insert_(idx, next_capacity_(size_ + 1), std::forward<Args>(args)...);
+  } else if (idx == size_) {
+    ::new (static_cast<void *>(arr_ + idx)) T(std::forward<Args>(args)...);
+    size_++;
+  } else {
+    // args may refer to an element that is about to be shifted
+    T tmp(std::forward<Args>(args)...);
+    relocate(arr_ + idx + 1, arr_ + idx, size_ - idx);
+    ::new (static_cast<void *>(arr_ + idx)) T(std::move(tmp));
+    size_++;
   }
-  auto size_to_move = size_ - idx;
-  copy_(arr_ + idx + 1, arr_ + idx, size_to_move);
-  arr_[idx] = value;
-  size_++;
+  return arr_ + idx;
+}
+
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+void vector<T, Growth, Alloc, Telemetry>::insert(vector::iterator pos, const T &value) {
+  insert(pos, 1, value);
 }
 
-template <typename T>
-void vector<T>::insert(vector::iterator pos, size_t size, const T &value) {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+void vector<T, Growth, Alloc, Telemetry>::insert(vector::iterator pos, size_t size, const T &value) {
   if (pos < begin() || pos > end()) {
     throw std::exception();
   }
-  auto idx = pos - begin();
-  while (max_size() < size) {
-    resize_(true);
+  auto idx = static_cast<size_t>(pos - begin());
+  if (size == 0) {
+    return;
   }
-  auto size_to_move = size_ - idx;
-  copy_(arr_ + idx + size, arr_ + idx, size_to_move);
-  for (auto i = 0; i < size; i++) {
-    arr_[idx + i] = value;
+  if (size_ + size <= capacity_ && &value >= begin() && &value < end()) {
+    // value lives inside arr_ and is about to be shifted
+    T tmp(value);
+    insert_n_(idx, size, [&](T *dst) { parallel::uninitialized_fill_n(dst, size, tmp); });
+    return;
   }
-  size_ += size;
+  insert_n_(idx, size, [&](T *dst) { parallel::uninitialized_fill_n(dst, size, value); });
 }
 
-template <typename T>
-void vector<T>::insert(vector::iterator pos, vector::iterator first, vector::iterator last) {
-  if (pos < begin() || pos > end() || last <= first) {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+template <typename InputIt, typename>
+void vector<T, Growth, Alloc, Telemetry>::insert(vector::iterator pos, InputIt first, InputIt last) {
+  if (pos < begin() || pos > end()) {
     throw std::exception();
   }
-  auto idx = pos - begin();
-  auto size = last - first;
-  while (max_size() < size) {
-    resize_(true);
+  auto idx = static_cast<size_t>(pos - begin());
+  if constexpr (is_forward_iterator_v<InputIt>) {
+    auto size = static_cast<size_t>(std::distance(first, last));
+    if (size == 0) {
+      return;
+    }
+    if constexpr (std::is_pointer_v<InputIt>) {
+      if (size_ + size <= capacity_ && first < end() && last > begin()) {
+        // [first, last) is a part of arr_ that is about to be shifted, copy it aside
+        auto tmp = vector<T, Growth, Alloc, Telemetry>(alloc_);
+        tmp.append(first, last);
+        insert_n_(idx, size, [&](T *dst) {
+          relocate(dst, tmp.arr_, size);
+          tmp.size_ = 0;
+        });
+        return;
+      }
+    }
+    insert_n_(idx, size, [&](T *dst) { parallel::uninitialized_copy(first, size, dst); });
+  } else {
+    // single pass: the length is unknown until the end, append then rotate into place
+    auto old_size = size_;
+    for (; first != last; ++first) {
+      emplace_back(*first);
+    }
+    std::rotate(begin() + idx, begin() + old_size, end());
   }
-  auto size_to_move = size_ - idx;
-  copy_(arr_ + idx + size, arr_ + idx, size_to_move);
-  auto i = 0;
-  for (auto itr = first; itr != last; itr++) {
-    arr_[idx + i++] = *itr;
+}
+
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+template <typename InputIt, typename>
+void vector<T, Growth, Alloc, Telemetry>::append(InputIt first, InputIt last) {
+  insert(end(), first, last);
+}
+
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+template <typename InputIt, typename>
+void vector<T, Growth, Alloc, Telemetry>::assign(InputIt first, InputIt last) {
+  if constexpr (is_forward_iterator_v<InputIt>) {
+    if constexpr (std::is_pointer_v<InputIt>) {
+      if (first < end() && last > begin()) {
+        // [first, last) is a part of arr_ that clear() would destroy
+        auto tmp = vector<T, Growth, Alloc, Telemetry>(alloc_);
+        tmp.append(first, last);
+        swap(tmp);
+        return;
+      }
+    }
+    auto size = static_cast<size_t>(std::distance(first, last));
+    clear();
+    if (size > capacity_) {
+      // nothing to keep, drop the old buffer instead of relocating
+      reallocated_(0);
+      deallocate_(arr_, capacity_);
+      arr_ = allocate_(size);
+      capacity_ = size;
+    }
+    parallel::uninitialized_copy(first, size, arr_);
+    size_ = size;
+  } else {
+    clear();
+    for (; first != last; ++first) {
+      emplace_back(*first);
+    }
   }
-  size_ += size;
 }
 
-template <typename T>
-void vector<T>::resize(size_t size) {
-  while (capacity() < size) {
-    resize_(true);
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+void vector<T, Growth, Alloc, Telemetry>::resize(size_t size) {
+  if (size < size_) {
+    destroy_(arr_ + size, end());
+    size_ = size;
+    return;
   }
+  resize_(size);
+  parallel::uninitialized_value_construct_n(arr_ + size_, size - size_);
   size_ = size;
-  for (auto i = size_; i < capacity_; i++) {
-    arr_[i] = T{};
-  }
 }
 
-template <typename T>
-void vector<T>::resize(size_t size, T value) {
-  auto old_size = size_;
-  while (capacity() < size) {
-    resize_(true);
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+void vector<T, Growth, Alloc, Telemetry>::resize(size_t size, T value) {
+  if (size < size_) {
+    destroy_(arr_ + size, end());
+    size_ = size;
+    return;
   }
+  resize_(size);
+  parallel::uninitialized_fill_n(arr_ + size_, size - size_, value);
   size_ = size;
-  for (auto i = old_size; i < size_; i++) {
-    arr_[i] = value;
-  }
 }
 
-template <typename T>
-void vector<T>::swap(vector<T> &other) {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+void vector<T, Growth, Alloc, Telemetry>::swap(vector<T, Growth, Alloc, Telemetry> &other) {
   auto tmp_size = size_;
   auto tmp_arr = arr_;
   auto tmp_capacity = capacity_;
@@ -361,60 +636,147 @@ void vector<T>::swap(vector<T> &other) {
   other.size_ = tmp_size;
   other.arr_ = tmp_arr;
   other.capacity_ = tmp_capacity;
+  if constexpr (alloc_traits::propagate_on_container_swap::value) {
+    std::swap(alloc_, other.alloc_);
+  }
 }
 
-template <typename T>
-void vector<T>::reserve(size_t new_cap) {
-  while (capacity() < new_cap) {
-    resize_(true);
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+void vector<T, Growth, Alloc, Telemetry>::reserve(size_t new_cap) {
+  if (new_cap > capacity_) {
+    realloc_(new_cap);
   }
 }
 
-template <typename T>
-T &vector<T>::operator[](size_t pos) {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+void vector<T, Growth, Alloc, Telemetry>::shrink_to_fit() {
+  // give back the spare capacity, an empty vector frees its buffer
+  if (capacity_ > size_) {
+    realloc_(size_);
+  }
+}
+
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+typename vector<T, Growth, Alloc, Telemetry>::iterator vector<T, Growth, Alloc, Telemetry>::find(const T &value) {
+  return arr_ + simd::find(arr_, size_, value);
+}
+
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+typename vector<T, Growth, Alloc, Telemetry>::const_iterator vector<T, Growth, Alloc, Telemetry>::find(
+    const T &value) const {
+  return arr_ + simd::find(arr_, size_, value);
+}
+
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+size_t vector<T, Growth, Alloc, Telemetry>::count(const T &value) const {
+  return simd::count(arr_, size_, value);
+}
+
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+bool vector<T, Growth, Alloc, Telemetry>::contains(const T &value) const {
+  return find(value) != end();
+}
+
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+typename vector<T, Growth, Alloc, Telemetry>::iterator vector<T, Growth, Alloc, Telemetry>::min_element() {
+  return empty() ? end() : arr_ + simd::min_index(arr_, size_);
+}
+
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+typename vector<T, Growth, Alloc, Telemetry>::iterator vector<T, Growth, Alloc, Telemetry>::max_element() {
+  return empty() ? end() : arr_ + simd::max_index(arr_, size_);
+}
+
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+T &vector<T, Growth, Alloc, Telemetry>::operator[](size_t pos) {
   return arr_[pos];
 }
 
-template <typename T>
-const T &vector<T>::operator[](size_t pos) const {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+const T &vector<T, Growth, Alloc, Telemetry>::operator[](size_t pos) const {
   return arr_[pos];
 }
 
-template <typename T>
-constexpr vector<T> &vector<T>::operator=(const vector<T> &other) {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+vector<T, Growth, Alloc, Telemetry> &vector<T, Growth, Alloc, Telemetry>::operator=(
+    const vector<T, Growth, Alloc, Telemetry> &other) {
+  if (this == &other) {
+    return *this;
+  }
+  // copy into the new storage first: if it throws, *this is left untouched
+  auto alloc = alloc_traits::propagate_on_container_copy_assignment::value ? other.alloc_ : alloc_;
+  auto new_arr = other.capacity_ == 0 ? nullptr : alloc_traits::allocate(alloc, other.capacity_);
+  try {
+    parallel::uninitialized_copy(other.arr_, other.size_, new_arr);
+  } catch (...) {
+    if (new_arr != nullptr) {
+      alloc_traits::deallocate(alloc, new_arr, other.capacity_);
+    }
+    throw;
+  }
+  destroy_(begin(), end());
+  deallocate_(arr_, capacity_);
+  if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+    alloc_ = std::move(alloc);
+  }
+  arr_ = new_arr;
   size_ = other.size_;
   capacity_ = other.capacity_;
-  delete[] arr_;
-  arr_ = new T[capacity_];
-  copy_(arr_, other.arr_, capacity_);
+  return *this;
 }
 
-template <typename T>
-constexpr vector<T> &vector<T>::operator=(vector<T> &&other) noexcept {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+constexpr vector<T, Growth, Alloc, Telemetry> &vector<T, Growth, Alloc, Telemetry>::operator=(
+    vector<T, Growth, Alloc, Telemetry> &&other) noexcept(alloc_traits::propagate_on_container_move_assignment::value ||
+                                                          alloc_traits::is_always_equal::value) {
+  if (this == &other) {
+    return *this;
+  }
+  destroy_(begin(), end());
+  if constexpr (!alloc_traits::propagate_on_container_move_assignment::value &&
+                !alloc_traits::is_always_equal::value) {
+    if (alloc_ != other.alloc_) {
+      // other's buffer cannot be released by alloc_, move the elements instead
+      size_ = 0;
+      resize_(other.size_);
+      relocate(arr_, other.arr_, other.size_);
+      size_ = other.size_;
+      other.size_ = 0;
+      return *this;
+    }
+  }
+  deallocate_(arr_, capacity_);
+  if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+    alloc_ = std::move(other.alloc_);
+  }
   size_ = other.size_;
   capacity_ = other.capacity_;
-  delete[] arr_;
   arr_ = other.arr_;
 
   other.arr_ = nullptr;
+  other.size_ = 0;
+  other.capacity_ = 0;
+  return *this;
 }
 
-template <typename T>
-bool vector<T>::operator==(const vector<T> &other) {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+bool vector<T, Growth, Alloc, Telemetry>::operator==(const vector<T, Growth, Alloc, Telemetry> &other) {
   if (size_ != other.size_) {
     return false;
   }
-  for (auto i = 0; i < size_; i++) {
-    if ((*this)[i] != other[i]) {
-      return false;
-    }
-  }
-  return true;
+  return parallel::equal(arr_, other.arr_, size_);
 }
 
-template <typename T>
-bool vector<T>::operator!=(const vector<T> &other) {
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+bool vector<T, Growth, Alloc, Telemetry>::operator!=(const vector<T, Growth, Alloc, Telemetry> &other) {
   return !(*this == other);
 }
 
+// vector only refers to its buffer through arr_, the allocator decides the rest; an instrumented vector is registered
+// by its address, it has to be moved properly
+template <typename T, typename Growth, typename Alloc, typename Telemetry>
+struct is_trivially_relocatable<vector<T, Growth, Alloc, Telemetry>>
+    : std::bool_constant<std::is_same_v<Telemetry, telemetry::off> &&
+                         (std::is_empty_v<Alloc> || is_trivially_relocatable_v<Alloc>)> {};
+
 }  // namespace STL
@@ -0,0 +1,115 @@
+#include "include/intrusive_list.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace STL {
+
+struct task : intrusive_list_hook {
+  int id_;
+  explicit task(int id) : id_(id) {}
+};
+
+// on a run queue and a timer list at the same time
+struct timer {
+  int id_;
+  intrusive_list_hook run_hook_;
+  intrusive_list_hook timer_hook_;
+  explicit timer(int id) : id_(id) {}
+};
+
+template <typename List>
+std::vector<int> ids(List &lst) {
+  auto result = std::vector<int>();
+  for (auto &value : lst) {
+    result.push_back(value.id_);
+  }
+  return result;
+}
+
+TEST(IntrusiveListTests, TestBaseHook) {
+  auto tasks = std::vector<task>();
+  for (auto i = 0; i < 5; i++) {
+    tasks.emplace_back(i);
+  }
+  auto lst = intrusive_list<task>();
+  ASSERT_TRUE(lst.empty());
+  for (auto &t : tasks) {
+    lst.push_back(t);
+  }
+  ASSERT_EQ(ids(lst), std::vector<int>({0, 1, 2, 3, 4}));
+  ASSERT_EQ(lst.size(), 5);
+  ASSERT_THROW(lst.push_back(tasks[0]), std::exception);
+
+  // objects leave on their own, by address only
+  tasks[2].unlink();
+  intrusive_list<task>::remove(tasks[4]);
+  ASSERT_FALSE(tasks[2].is_linked());
+  ASSERT_EQ(ids(lst), std::vector<int>({0, 1, 3}));
+  lst.push_front(tasks[2]);
+  ASSERT_EQ(&lst.front(), &tasks[2]);
+  lst.pop_front();
+  lst.pop_back();
+  ASSERT_EQ(ids(lst), std::vector<int>({0, 1}));
+
+  auto itr = lst.insert(lst.iterator_to(tasks[1]), tasks[3]);
+  ASSERT_EQ(itr->id_, 3);
+  itr = lst.erase(lst.begin());
+  ASSERT_EQ(itr->id_, 3);
+  ASSERT_EQ(ids(lst), std::vector<int>({3, 1}));
+  itr--;
+  ASSERT_EQ(itr, lst.end());
+
+  // a destroyed object unlinks itself
+  {
+    auto tmp = task(9);
+    lst.push_back(tmp);
+    ASSERT_EQ(lst.size(), 3);
+  }
+  ASSERT_EQ(ids(lst), std::vector<int>({3, 1}));
+
+  lst.clear();
+  ASSERT_TRUE(lst.empty());
+  ASSERT_FALSE(tasks[1].is_linked());
+}
+
+TEST(IntrusiveListTests, TestMemberHook) {
+  using run_queue = intrusive_list<timer, member_hook<timer, &timer::run_hook_>>;
+  using timer_list = intrusive_list<timer, member_hook<timer, &timer::timer_hook_>>;
+  auto timers = std::vector<timer>();
+  for (auto i = 0; i < 6; i++) {
+    timers.emplace_back(i);
+  }
+  auto ready = run_queue();
+  auto waiting = run_queue();
+  auto expiring = timer_list();
+  for (auto &t : timers) {
+    (t.id_ % 2 == 0 ? ready : waiting).push_back(t);
+    expiring.push_front(t);
+  }
+  ASSERT_EQ(ids(ready), std::vector<int>({0, 2, 4}));
+  ASSERT_EQ(ids(waiting), std::vector<int>({1, 3, 5}));
+  ASSERT_EQ(ids(expiring), std::vector<int>({5, 4, 3, 2, 1, 0}));
+
+  // move single objects and whole lists between lists
+  ready.splice(ready.begin(), timers[3]);
+  ASSERT_EQ(ids(ready), std::vector<int>({3, 0, 2, 4}));
+  ASSERT_EQ(ids(waiting), std::vector<int>({1, 5}));
+  ready.splice(ready.end(), waiting);
+  ASSERT_TRUE(waiting.empty());
+  ASSERT_EQ(ids(ready), std::vector<int>({3, 0, 2, 4, 1, 5}));
+  ready.splice(ready.end(), timers[3]);
+  ASSERT_EQ(ids(ready), std::vector<int>({0, 2, 4, 1, 5, 3}));
+  ASSERT_EQ(ids(expiring), std::vector<int>({5, 4, 3, 2, 1, 0}));
+
+  auto moved = std::move(ready);
+  ASSERT_TRUE(ready.empty());
+  ASSERT_EQ(ids(moved), std::vector<int>({0, 2, 4, 1, 5, 3}));
+  moved.swap(waiting);
+  ASSERT_TRUE(moved.empty());
+  ASSERT_EQ(ids(waiting), std::vector<int>({0, 2, 4, 1, 5, 3}));
+  timer_list::remove(timers[0]);
+  ASSERT_EQ(ids(expiring), std::vector<int>({5, 4, 3, 2, 1}));
+  ASSERT_EQ(waiting.size(), 6);
+}
+
+}  // namespace STL
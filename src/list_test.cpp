@@ -1,6 +1,10 @@
 #include "include/list.h"
 #include <gtest/gtest.h>
 #include <list>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace STL {
 
@@ -122,4 +126,269 @@ TEST(ListTests, TestModifier) {
   ASSERT_TRUE(list == list_empty);
 }
 
+TEST(ListTests, TestSentinel) {
+  // the sentinel lives in the list object, moves and swaps relink the ends to the new owner
+  auto list1 = list<int>({1, 2, 3});
+  auto list1_ref = std::list<int>({1, 2, 3});
+  auto list2 = std::move(list1);
+  ASSERT_TRUE(list1.empty());
+  ASSERT_EQ(list1.begin(), list1.end());
+  check_equal(list2, list1_ref);
+  list2.push_back(4);
+  list2.push_front(0);
+  list1_ref.push_back(4);
+  list1_ref.push_front(0);
+  check_equal(list2, list1_ref);
+  auto itr = list2.end();
+  itr--;
+  ASSERT_EQ(*itr, 4);
+
+  auto list3 = list<int>();
+  auto list3_ref = std::list<int>();
+  list3.swap(list2);
+  list3_ref.swap(list1_ref);
+  check_equal(list2, list1_ref);
+  check_equal(list3, list3_ref);
+  list2.push_back(5);
+  list1_ref.push_back(5);
+  check_equal(list2, list1_ref);
+
+  list1 = std::move(list3);
+  check_equal(list1, list3_ref);
+  list1.pop_back();
+  list3_ref.pop_back();
+  check_equal(list1, list3_ref);
+
+  // lists of lists are moved around by vector-like containers
+  auto lists = std::vector<list<int>>();
+  for (auto i = 0; i < 100; i++) {
+    lists.emplace_back(list<int>({i, i + 1}));
+  }
+  for (auto i = 0; i < 100; i++) {
+    ASSERT_EQ(*lists[i].begin(), i);
+    ASSERT_EQ(lists[i].size(), 2);
+  }
+}
+
+TEST(ListTests, TestSplice) {
+  auto list1 = list<int>({1, 2, 3});
+  auto list2 = list<int>({4, 5, 6, 7});
+  auto list1_ref = std::list<int>({1, 2, 3});
+  auto list2_ref = std::list<int>({4, 5, 6, 7});
+
+  // single node, the node itself moves: iterators to it stay valid
+  auto itr = list2.begin();
+  itr++;
+  auto addr = &*itr;
+  list1.splice(list1.begin(), list2, itr);
+  list1_ref.splice(list1_ref.begin(), list2_ref, std::next(list2_ref.begin()));
+  check_equal(list1, list1_ref);
+  check_equal(list2, list2_ref);
+  ASSERT_EQ(&*list1.begin(), addr);
+
+  // ranges, with and without the size
+  auto last = list2.end();
+  last--;
+  list1.splice(list1.end(), list2, list2.begin(), last);
+  list1_ref.splice(list1_ref.end(), list2_ref, list2_ref.begin(), std::prev(list2_ref.end()));
+  check_equal(list1, list1_ref);
+  check_equal(list2, list2_ref);
+  list2.splice(list2.begin(), list1, list1.begin(), list1.end(), list1.size());
+  list2_ref.splice(list2_ref.begin(), list1_ref, list1_ref.begin(), list1_ref.end());
+  check_equal(list1, list1_ref);
+  check_equal(list2, list2_ref);
+
+  // within one list
+  auto first = list2.begin();
+  first++;
+  list2.splice(list2.begin(), list2, first, list2.end());
+  list2_ref.splice(list2_ref.begin(), list2_ref, std::next(list2_ref.begin()), list2_ref.end());
+  check_equal(list2, list2_ref);
+  list2.splice(list2.end(), list2, list2.begin());
+  list2_ref.splice(list2_ref.end(), list2_ref, list2_ref.begin());
+  check_equal(list2, list2_ref);
+  list2.splice(list2.begin(), list2, list2.begin());
+  check_equal(list2, list2_ref);
+
+  // whole lists
+  list1.splice(list1.end(), list2);
+  list1_ref.splice(list1_ref.end(), list2_ref);
+  check_equal(list1, list1_ref);
+  check_equal(list2, list2_ref);
+  list1.splice(list1.begin(), list<int>({-1, -2}));
+  list1_ref.splice(list1_ref.begin(), std::list<int>({-1, -2}));
+  check_equal(list1, list1_ref);
+}
+
+TEST(ListTests, TestSort) {
+  auto gen = std::mt19937(42);
+  auto dist = std::uniform_int_distribution<int>(0, 1000);
+  // (key, original position): equal keys must keep their order
+  auto lst = list<std::pair<int, int>>();
+  auto lst_ref = std::list<std::pair<int, int>>();
+  for (auto i = 0; i < 100000; i++) {
+    auto v = std::make_pair(dist(gen), i);
+    lst.push_back(v);
+    lst_ref.push_back(v);
+  }
+  auto by_key = [](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.first < b.first; };
+  auto addrs = std::vector<std::pair<int, int> *>();
+  for (auto &v : lst) {
+    addrs.push_back(&v);
+  }
+  lst.sort(by_key);
+  lst_ref.sort(by_key);
+  check_equal(lst, lst_ref);
+  // values are relinked, not copied
+  for (auto &v : lst) {
+    ASSERT_EQ(addrs[v.second], &v);
+  }
+  auto itr = lst.end();
+  for (auto itr_ref = lst_ref.rbegin(); itr_ref != lst_ref.rend(); itr_ref++) {
+    itr--;
+    ASSERT_EQ(*itr, *itr_ref);
+  }
+
+  auto small = list<int>({3, 1, 2});
+  small.sort();
+  ASSERT_TRUE(small == list<int>({1, 2, 3}));
+  small.sort(std::greater<>());
+  ASSERT_TRUE(small == list<int>({3, 2, 1}));
+  auto empty = list<int>();
+  empty.sort();
+  ASSERT_TRUE(empty.empty());
+
+  auto list1 = list<int>({1, 3, 5, 7});
+  auto list2 = list<int>({0, 2, 3, 8, 9});
+  auto list1_ref = std::list<int>({1, 3, 5, 7});
+  auto list2_ref = std::list<int>({0, 2, 3, 8, 9});
+  list1.merge(list2);
+  list1_ref.merge(list2_ref);
+  check_equal(list1, list1_ref);
+  check_equal(list2, list2_ref);
+  list2.push_back(4);
+  list2_ref.push_back(4);
+  list1.merge(list2);
+  list1_ref.merge(list2_ref);
+  check_equal(list1, list1_ref);
+}
+
+TEST(ListTests, TestReverseUnique) {
+  auto lst = list<int>({1, 1, 2, 3, 3, 3, 1, 4, 4});
+  auto lst_ref = std::list<int>({1, 1, 2, 3, 3, 3, 1, 4, 4});
+  ASSERT_EQ(lst.unique(), 4);
+  lst_ref.unique();
+  check_equal(lst, lst_ref);
+
+  lst.reverse();
+  lst_ref.reverse();
+  check_equal(lst, lst_ref);
+  lst.push_back(10);
+  lst_ref.push_back(10);
+  lst.push_front(-10);
+  lst_ref.push_front(-10);
+  check_equal(lst, lst_ref);
+
+  ASSERT_EQ(lst.unique([](int a, int b) { return b == a + 1 || b == a - 1; }), 1);
+  lst_ref.unique([](int a, int b) { return b == a + 1 || b == a - 1; });
+  check_equal(lst, lst_ref);
+
+  auto empty = list<int>();
+  empty.reverse();
+  ASSERT_EQ(empty.unique(), 0);
+  ASSERT_TRUE(empty.empty());
+}
+
+// not default constructible, counts its copies
+struct payload {
+  static inline int copies = 0;
+  static inline int moves = 0;
+
+  int a_;
+  std::string b_;
+
+  payload(int a, std::string b) : a_(a), b_(std::move(b)) {}
+  payload(const payload &other) : a_(other.a_), b_(other.b_) { copies++; }
+  payload(payload &&other) noexcept : a_(other.a_), b_(std::move(other.b_)) { moves++; }
+  payload &operator=(const payload &other) = default;
+  bool operator!=(const payload &other) const { return a_ != other.a_ || b_ != other.b_; }
+};
+
+TEST(ListTests, TestEmplace) {
+  payload::copies = 0;
+  payload::moves = 0;
+  auto lst = list<payload>();
+  auto &back = lst.emplace_back(1, "one");
+  auto &front = lst.emplace_front(0, "zero");
+  ASSERT_EQ(back.b_, "one");
+  ASSERT_EQ(front.a_, 0);
+  auto itr = lst.emplace(lst.end(), 2, "two");
+  ASSERT_EQ(itr->b_, "two");
+  ASSERT_EQ(payload::copies, 0);
+  ASSERT_EQ(payload::moves, 0);
+
+  // rvalues are moved into the node, once
+  lst.push_back(payload(3, "three"));
+  lst.push_front(payload(-1, "minus one"));
+  itr = lst.insert(lst.begin(), payload(-2, "minus two"));
+  ASSERT_EQ(itr->a_, -2);
+  ASSERT_EQ(payload::copies, 0);
+  ASSERT_EQ(payload::moves, 3);
+
+  auto p = payload(4, "four");
+  lst.push_back(p);
+  ASSERT_EQ(payload::copies, 1);
+  auto expected = std::vector<int>({-2, -1, 0, 1, 2, 3, 4});
+  auto i = 0;
+  for (auto &v : lst) {
+    ASSERT_EQ(v.a_, expected[i++]);
+  }
+
+  auto lst_c = lst;
+  ASSERT_EQ(payload::copies, 8);
+  ASSERT_TRUE(lst_c == lst);
+  lst.pop_back();
+  lst.pop_front();
+  lst.clear();
+  ASSERT_TRUE(lst.empty());
+}
+
+// counts live instances
+struct tracked {
+  static inline int alive = 0;
+
+  int v_;
+
+  explicit tracked(int v) : v_(v) { alive++; }
+  tracked(const tracked &other) : v_(other.v_) { alive++; }
+  ~tracked() { alive--; }
+};
+
+TEST(ListTests, TestClear) {
+  tracked::alive = 0;
+  {
+    auto lst = list<tracked>();
+    for (auto i = 0; i < 10000; i++) {
+      lst.emplace_back(i);
+    }
+    lst.clear();
+    ASSERT_EQ(tracked::alive, 0);
+    ASSERT_TRUE(lst.empty());
+    ASSERT_EQ(lst.begin(), lst.end());
+
+    // the list is usable again after clear
+    lst.emplace_back(1);
+    lst.emplace_front(0);
+    ASSERT_EQ(lst.size(), 2);
+    ASSERT_EQ(lst.begin()->v_, 0);
+    ASSERT_EQ((--lst.end())->v_, 1);
+    for (auto i = 0; i < 100; i++) {
+      lst.emplace_back(i);
+    }
+    ASSERT_EQ(tracked::alive, 102);
+  }
+  // the destructor tears down the same way
+  ASSERT_EQ(tracked::alive, 0);
+}
+
 }  // namespace STL
@@ -0,0 +1,163 @@
+#include "include/lru_cache.h"
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <list>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+// counts the allocations of the whole program
+static size_t allocations = 0;
+
+void *operator new(size_t size) {
+  allocations++;
+  if (auto p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t /* size */) noexcept { std::free(p); }
+
+namespace STL {
+
+TEST(LruCacheTests, TestGetPut) {
+  auto cache = lru_cache<int, std::string>(3);
+  ASSERT_TRUE(cache.empty());
+  ASSERT_EQ(cache.get(1), nullptr);
+  ASSERT_TRUE(cache.put(1, "one"));
+  ASSERT_TRUE(cache.put(2, "two"));
+  ASSERT_TRUE(cache.put(3, "three"));
+  ASSERT_EQ(cache.size(), 3);
+  ASSERT_EQ(*cache.get(1), "one");
+
+  // 2 is the least recently used now
+  ASSERT_TRUE(cache.put(4, "four"));
+  ASSERT_EQ(cache.size(), 3);
+  ASSERT_FALSE(cache.contains(2));
+  ASSERT_EQ(cache.evictions(), 1);
+
+  // touch and peek: 3 is saved, peek does not count
+  ASSERT_TRUE(cache.touch(3));
+  ASSERT_FALSE(cache.touch(2));
+  ASSERT_EQ(*cache.peek(1), "one");
+  ASSERT_TRUE(cache.put(5, "five"));
+  ASSERT_FALSE(cache.contains(1));
+  ASSERT_TRUE(cache.contains(3));
+
+  // assign keeps the size, and marks the entry
+  ASSERT_TRUE(cache.put(4, "FOUR"));
+  ASSERT_EQ(cache.size(), 3);
+  ASSERT_TRUE(cache.evict());
+  ASSERT_FALSE(cache.contains(3));
+  ASSERT_EQ(*cache.get(4), "FOUR");
+
+  ASSERT_EQ(cache.hits(), 2);
+  ASSERT_EQ(cache.misses(), 1);
+  ASSERT_EQ(cache.evictions(), 3);
+  cache.reset_stats();
+  ASSERT_EQ(cache.hits() + cache.misses() + cache.evictions(), 0);
+
+  ASSERT_TRUE(cache.erase(5));
+  ASSERT_FALSE(cache.erase(5));
+  ASSERT_EQ(cache.size(), 1);
+  cache.clear();
+  ASSERT_TRUE(cache.empty());
+  ASSERT_FALSE(cache.evict());
+}
+
+TEST(LruCacheTests, TestWeight) {
+  auto bytes = [](const std::string &key, const std::string &value) { return key.size() + value.size(); };
+  auto cache = lru_cache<std::string, std::string, std::hash<std::string>, decltype(bytes)>(20, bytes);
+  ASSERT_TRUE(cache.put("a", "123456789"));
+  ASSERT_TRUE(cache.put("b", "123456789"));
+  ASSERT_EQ(cache.weight(), 20);
+
+  // one heavy entry evicts both
+  ASSERT_TRUE(cache.put("c", std::string(15, 'x')));
+  ASSERT_EQ(cache.size(), 1);
+  ASSERT_EQ(cache.weight(), 16);
+  ASSERT_EQ(cache.evictions(), 2);
+
+  // too heavy: not cached, and the old value goes away
+  ASSERT_FALSE(cache.put("c", std::string(20, 'x')));
+  ASSERT_TRUE(cache.empty());
+  ASSERT_EQ(cache.weight(), 0);
+
+  // growing an entry evicts the others
+  ASSERT_TRUE(cache.put("a", "1"));
+  ASSERT_TRUE(cache.put("b", "1"));
+  ASSERT_TRUE(cache.put("a", std::string(18, 'x')));
+  ASSERT_EQ(cache.size(), 1);
+  ASSERT_TRUE(cache.contains("a"));
+  ASSERT_EQ(cache.weight(), 19);
+
+  cache.set_capacity(10);
+  ASSERT_TRUE(cache.empty());
+}
+
+TEST(LruCacheTests, TestRandom) {
+  const size_t capacity = 64;
+  auto cache = lru_cache<int, int>(capacity);
+  // the reference: keys from the most to the least recently used
+  auto order = std::list<int>();
+  auto values = std::unordered_map<int, int>();
+  auto rng = std::mt19937(7);
+  for (auto i = 0; i < 20000; i++) {
+    auto key = static_cast<int>(rng() % 100);
+    auto op = rng() % 3;
+    auto found = values.count(key) > 0;
+    if (found && op != 2) {
+      order.remove(key);
+      order.push_front(key);
+    }
+    if (op == 0) {
+      auto value = cache.get(key);
+      ASSERT_EQ(value != nullptr, found);
+      if (found) {
+        ASSERT_EQ(*value, values[key]);
+      }
+    } else if (op == 1) {
+      ASSERT_TRUE(cache.put(key, i));
+      if (!found) {
+        order.push_front(key);
+        if (order.size() > capacity) {
+          values.erase(order.back());
+          order.pop_back();
+        }
+      }
+      values[key] = i;
+    } else {
+      ASSERT_EQ(cache.erase(key), found);
+      if (found) {
+        order.remove(key);
+        values.erase(key);
+      }
+    }
+    ASSERT_EQ(cache.size(), order.size());
+  }
+  for (auto key : order) {
+    ASSERT_EQ(*cache.peek(key), values[key]);
+  }
+}
+
+TEST(LruCacheTests, TestNoAllocation) {
+  auto cache = lru_cache<int, std::string>(1000);
+  // fill, then warm up the node pools with a round of evictions
+  for (auto i = 0; i < 2000; i++) {
+    cache.put(i, std::string(100, 'a' + i % 26));
+  }
+  auto value = std::string(100, 'z');
+  auto before = allocations;
+  for (auto i = 2000; i < 100000; i++) {
+    ASSERT_NE(cache.get(i - 500), nullptr);
+    // value is copied into a recycled string of the same size
+    cache.put(i, value);
+  }
+  ASSERT_EQ(allocations, before);
+  ASSERT_EQ(cache.evictions(), 99000);
+}
+
+}  // namespace STL
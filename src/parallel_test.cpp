@@ -0,0 +1,158 @@
+#include "include/parallel.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "include/vector.h"
+
+namespace STL {
+
+// split every range into `chunks` pieces for the duration of a test
+struct force_split {
+  size_t threshold_ = parallel::threshold();
+  size_t max_chunks_ = parallel::max_chunks();
+
+  explicit force_split(size_t chunks) {
+    parallel::set_threshold(0);
+    parallel::set_max_chunks(chunks);
+  }
+  ~force_split() {
+    parallel::set_threshold(threshold_);
+    parallel::set_max_chunks(max_chunks_);
+  }
+};
+
+TEST(ParallelTests, TestChunks) {
+  auto saved = force_split(4);
+  parallel::set_threshold(64);
+  ASSERT_EQ(parallel::chunks(10, 8), 4);
+  ASSERT_EQ(parallel::chunks(10, 4), 1);
+  ASSERT_EQ(parallel::chunks(3, 64), 3);
+  ASSERT_EQ(parallel::chunks(0, 64), 1);
+
+  // the same cut every time, whichever thread runs a chunk
+  auto mutex = std::mutex();
+  auto ranges = std::vector<std::pair<size_t, size_t>>();
+  parallel::for_each_chunk(10, 8, [&](size_t first, size_t last) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ranges.emplace_back(first, last);
+  });
+  std::sort(ranges.begin(), ranges.end());
+  ASSERT_EQ(ranges, (std::vector<std::pair<size_t, size_t>>({{0, 2}, {2, 5}, {5, 7}, {7, 10}})));
+}
+
+TEST(ParallelTests, TestThreadPool) {
+  auto pool = parallel::thread_pool(4);
+  ASSERT_EQ(pool.size(), 4);
+  auto hits = std::vector<std::atomic<int>>(1000);
+  pool.run(hits.size(), [&](size_t i) { hits[i]++; });
+  for (auto &hit : hits) {
+    ASSERT_EQ(hit.load(), 1);
+  }
+
+  // tasks may run jobs themselves
+  auto total = std::atomic<size_t>(0);
+  pool.run(8, [&](size_t i) { pool.run(100, [&](size_t j) { total += i * 100 + j; }); });
+  ASSERT_EQ(total.load(), 800 * 799 / 2);
+
+  for (auto round = 0; round < 100; round++) {
+    auto count = std::atomic<int>(0);
+    pool.run(round, [&](size_t) { count++; });
+    ASSERT_EQ(count.load(), round);
+  }
+}
+
+// cannot be compared
+struct throwing_eq {
+  bool operator==(const throwing_eq & /* other */) const { throw std::exception(); }
+  bool operator!=(const throwing_eq &other) const { return !(*this == other); }
+};
+
+TEST(ParallelTests, TestAlgorithms) {
+  auto saved = force_split(7);
+  const size_t n = 10001;
+  auto src = std::vector<int>(n);
+  for (size_t i = 0; i < n; i++) {
+    src[i] = static_cast<int>(i);
+  }
+
+  auto buf = std::allocator<int>().allocate(n);
+  parallel::uninitialized_copy(src.data(), n, buf);
+  ASSERT_TRUE(std::equal(src.begin(), src.end(), buf));
+  ASSERT_TRUE(parallel::equal(src.data(), buf, n));
+  // a mismatch at either end of a chunk
+  for (auto i : {size_t(0), n / 7 - 1, n / 7, n - 1}) {
+    buf[i]++;
+    ASSERT_FALSE(parallel::equal(src.data(), buf, n));
+    buf[i]--;
+  }
+
+  parallel::uninitialized_fill_n(buf, n, -3);
+  ASSERT_EQ(std::count(buf, buf + n, -3), n);
+  parallel::uninitialized_value_construct_n(buf, n);
+  ASSERT_EQ(std::count(buf, buf + n, 0), n);
+  // any random access source is split, the others are copied on the calling thread
+  parallel::uninitialized_copy(src.rbegin(), n, buf);
+  ASSERT_TRUE(std::equal(src.rbegin(), src.rend(), buf));
+  auto lst = std::list<int>(src.begin(), src.end());
+  parallel::uninitialized_copy(lst.begin(), n, buf);
+  ASSERT_TRUE(std::equal(src.begin(), src.end(), buf));
+  std::allocator<int>().deallocate(buf, n);
+
+  // throwing copies stay on the calling thread
+  auto strs = std::allocator<std::string>().allocate(100);
+  parallel::uninitialized_fill_n(strs, 100, std::string("abc"));
+  ASSERT_EQ(std::count(strs, strs + 100, "abc"), 100);
+  std::destroy_n(strs, 100);
+  std::allocator<std::string>().deallocate(strs, 100);
+
+  // any type is compared chunk by chunk, exceptions reach the caller
+  auto pairs = std::vector<std::pair<int, int>>(n, {1, 2});
+  auto pairs_c = pairs;
+  ASSERT_TRUE(parallel::equal(pairs.data(), pairs_c.data(), n));
+  pairs_c[n - 1].second = 3;
+  ASSERT_FALSE(parallel::equal(pairs.data(), pairs_c.data(), n));
+  auto thrower = std::vector<throwing_eq>(n);
+  ASSERT_THROW(parallel::equal(thrower.data(), thrower.data(), n), std::exception);
+}
+
+TEST(ParallelTests, TestVector) {
+  auto saved = force_split(5);
+  auto vec = vector<long>(100000, 7L);
+  auto vec_ref = std::vector<long>(100000, 7L);
+  ASSERT_TRUE(std::equal(vec.begin(), vec.end(), vec_ref.begin()));
+
+  vec.resize(250000, 9L);
+  vec_ref.resize(250000, 9L);
+  ASSERT_EQ(vec.size(), vec_ref.size());
+  ASSERT_TRUE(std::equal(vec.begin(), vec.end(), vec_ref.begin()));
+
+  auto vec_c = vec;
+  ASSERT_TRUE(vec_c == vec);
+  vec_c[249999] = 0;
+  ASSERT_TRUE(vec_c != vec);
+  vec_c = vec;
+  ASSERT_TRUE(vec_c == vec);
+
+  // range construction, insertion and assignment
+  vec.resize(300000);
+  vec_ref.resize(300000);
+  vec.insert(vec.begin() + 1, vec_ref.begin(), vec_ref.end());
+  vec_ref.insert(vec_ref.begin() + 1, vec_ref.begin(), vec_ref.end());
+  vec.insert(vec.begin() + 2, 100000, 3L);
+  vec_ref.insert(vec_ref.begin() + 2, 100000, 3L);
+  ASSERT_EQ(vec.size(), vec_ref.size());
+  ASSERT_TRUE(std::equal(vec.begin(), vec.end(), vec_ref.begin()));
+  auto vec_r = vector<long>(vec.begin(), vec.end());
+  ASSERT_TRUE(vec_r == vec);
+  vec_ref.assign(vec_ref.size() / 2, 4L);
+  vec.assign(vec_ref.begin(), vec_ref.end());
+  ASSERT_EQ(vec.size(), vec_ref.size());
+  ASSERT_TRUE(std::equal(vec.begin(), vec.end(), vec_ref.begin()));
+}
+
+}  // namespace STL
@@ -0,0 +1,82 @@
+#include "include/pool_allocator.h"
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "include/list.h"
+
+namespace STL {
+
+TEST(PoolAllocatorTests, TestReuse) {
+  using pool_t = node_pool<sizeof(std::string), alignof(std::string)>;
+  auto alloc = pool_allocator<std::string>();
+  auto blocks = std::vector<std::string *>();
+  for (auto i = 0; i < 1000; i++) {
+    auto p = alloc.allocate(1);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(p) % alignof(std::string), 0);
+    ::new (static_cast<void *>(p)) std::string(std::to_string(i));
+    blocks.push_back(p);
+  }
+  ASSERT_EQ(std::set<std::string *>(blocks.begin(), blocks.end()).size(), blocks.size());
+  for (auto i = 0; i < 1000; i++) {
+    ASSERT_EQ(*blocks[i], std::to_string(i));
+    blocks[i]->~basic_string();
+    alloc.deallocate(blocks[i], 1);
+  }
+
+  // freed blocks are handed out again instead of carving new ones
+  auto carved = pool_t::blocks();
+  for (auto round = 0; round < 10; round++) {
+    for (auto &p : blocks) {
+      p = alloc.allocate(1);
+    }
+    for (auto p : blocks) {
+      alloc.deallocate(p, 1);
+    }
+  }
+  ASSERT_EQ(pool_t::blocks(), carved);
+
+  // arrays bypass the pool
+  auto arr = alloc.allocate(10);
+  alloc.deallocate(arr, 10);
+  ASSERT_TRUE(alloc == pool_allocator<int>());
+}
+
+TEST(PoolAllocatorTests, TestThreads) {
+  // lists use the pool only when asked to
+  static_assert(std::is_same_v<list<int>::allocator_type, std::allocator<int>>);
+  static_assert(std::is_same_v<pooled_list<int>::allocator_type, pool_allocator<int>>);
+
+  // blocks allocated by one thread and freed by another
+  auto lists = std::vector<pooled_list<int>>(4);
+  auto threads = std::vector<std::thread>();
+  for (auto t = 0; t < 4; t++) {
+    threads.emplace_back([&lists, t] {
+      for (auto i = 0; i < 10000; i++) {
+        lists[t].push_back(i);
+        if (i % 3 == 0) {
+          lists[t].pop_front();
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+  for (auto &lst : lists) {
+    ASSERT_EQ(lst.size(), 10000 - 3334);
+  }
+  for (auto t = 0; t < 4; t++) {
+    threads.emplace_back([&lists, t] { lists[3 - t].clear(); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (auto &lst : lists) {
+    ASSERT_TRUE(lst.empty());
+  }
+}
+
+}  // namespace STL
@@ -0,0 +1,107 @@
+#include "include/simd.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace STL {
+
+// every level the machine supports, from scalar up
+std::vector<simd::isa> levels() {
+  auto all = std::vector<simd::isa>();
+  for (auto level : {simd::isa::scalar, simd::isa::sse2, simd::isa::avx2}) {
+    if (simd::limit(level) == level) {
+      all.push_back(level);
+    }
+  }
+  simd::limit(simd::isa::avx2);
+  return all;
+}
+
+template <typename T>
+std::vector<T> random_values(std::mt19937 &gen, size_t n, int range) {
+  auto dist = std::uniform_int_distribution<int>(-range, range);
+  auto values = std::vector<T>(n);
+  for (auto &v : values) {
+    v = static_cast<T>(dist(gen));
+  }
+  return values;
+}
+
+// compare all kernels with the scalar loops on arrays of every length up to 200
+template <typename T>
+void check_kernels() {
+  auto gen = std::mt19937(42);
+  for (auto level : levels()) {
+    simd::limit(level);
+    for (size_t n = 0; n < 200; n++) {
+      auto a = random_values<T>(gen, n, 50);
+      auto b = a;
+      ASSERT_TRUE(simd::equal(a.data(), b.data(), n));
+      if (n > 0) {
+        b[gen() % n] += 1;
+        ASSERT_EQ(simd::equal(a.data(), b.data(), n), simd::scalar::equal(a.data(), b.data(), n));
+      }
+      for (int v = -3; v <= 3; v++) {
+        auto value = static_cast<T>(v);
+        ASSERT_EQ(simd::find(a.data(), n, value), simd::scalar::find(a.data(), n, value));
+        ASSERT_EQ(simd::count(a.data(), n, value), simd::scalar::count(a.data(), n, value));
+      }
+      ASSERT_EQ(simd::min_index(a.data(), n), simd::scalar::min_index(a.data(), n));
+      ASSERT_EQ(simd::max_index(a.data(), n), simd::scalar::max_index(a.data(), n));
+    }
+  }
+  simd::limit(simd::isa::avx2);
+}
+
+TEST(SimdTests, TestIntegers) {
+  check_kernels<int8_t>();
+  check_kernels<uint8_t>();
+  check_kernels<int16_t>();
+  check_kernels<uint16_t>();
+  check_kernels<int32_t>();
+  check_kernels<uint32_t>();
+  check_kernels<int64_t>();
+  check_kernels<uint64_t>();
+}
+
+TEST(SimdTests, TestFloatingPoint) {
+  check_kernels<float>();
+  check_kernels<double>();
+
+  // NaN never compares equal, signed zeros do
+  auto nan = std::numeric_limits<double>::quiet_NaN();
+  auto a = std::vector<double>(64, 1.0);
+  a[40] = nan;
+  a[50] = -0.0;
+  for (auto level : levels()) {
+    simd::limit(level);
+    ASSERT_FALSE(simd::equal(a.data(), a.data(), a.size()));
+    ASSERT_EQ(simd::find(a.data(), a.size(), nan), a.size());
+    ASSERT_EQ(simd::find(a.data(), a.size(), 0.0), 50);
+    ASSERT_EQ(simd::count(a.data(), a.size(), 1.0), 62);
+  }
+  simd::limit(simd::isa::avx2);
+}
+
+TEST(SimdTests, TestExtremes) {
+  // lanes holding the type's limits, away from the scalar tail
+  auto a = std::vector<uint32_t>(1000, 7);
+  a[333] = 0;
+  a[334] = 0;
+  a[777] = std::numeric_limits<uint32_t>::max();
+  auto b = std::vector<int8_t>(1000, 0);
+  b[100] = -128;
+  b[900] = 127;
+  for (auto level : levels()) {
+    simd::limit(level);
+    ASSERT_EQ(simd::min_index(a.data(), a.size()), 333);
+    ASSERT_EQ(simd::max_index(a.data(), a.size()), 777);
+    ASSERT_EQ(simd::min_index(b.data(), b.size()), 100);
+    ASSERT_EQ(simd::max_index(b.data(), b.size()), 900);
+  }
+  simd::limit(simd::isa::avx2);
+}
+
+}  // namespace STL
@@ -0,0 +1,300 @@
+#include "include/small_vector.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace STL {
+
+template <typename T, size_t N, typename Growth, typename Alloc>
+void check_equal(const small_vector<T, N, Growth, Alloc> &vec, const std::vector<T> &vec_ref) {
+  ASSERT_EQ(vec.size(), vec_ref.size());
+  auto itr = vec.begin();
+  auto itr_ref = vec_ref.begin();
+  for (; itr != vec.end() && itr_ref != vec_ref.end(); itr++, itr_ref++) {
+    ASSERT_EQ(*itr, *itr_ref);
+  }
+  ASSERT_TRUE(itr_ref == vec_ref.end() && itr == vec.end());
+}
+
+// std::allocator that counts how often it is asked for memory
+template <typename T>
+struct counting_allocator : std::allocator<T> {
+  static inline int allocations = 0;
+
+  template <typename U>
+  struct rebind {
+    using other = counting_allocator<U>;
+  };
+
+  counting_allocator() = default;
+  template <typename U>
+  counting_allocator(const counting_allocator<U> & /* other */) {}
+
+  T *allocate(size_t n) {
+    allocations++;
+    return std::allocator<T>::allocate(n);
+  }
+};
+
+// allocator that compares unequal and stays with its container on move assignment
+template <typename T>
+struct pinned_allocator : std::allocator<T> {
+  using is_always_equal = std::false_type;
+  using propagate_on_container_move_assignment = std::false_type;
+
+  template <typename U>
+  struct rebind {
+    using other = pinned_allocator<U>;
+  };
+
+  pinned_allocator() = default;
+  template <typename U>
+  pinned_allocator(const pinned_allocator<U> & /* other */) {}
+
+  bool operator==(const pinned_allocator & /* other */) const { return false; }
+  bool operator!=(const pinned_allocator & /* other */) const { return true; }
+};
+
+TEST(SmallVectorTests, TestInline) {
+  using small = small_vector<std::string, 4, growth::doubling, counting_allocator<std::string>>;
+  counting_allocator<std::string>::allocations = 0;
+
+  auto vec = small();
+  auto vec_ref = std::vector<std::string>();
+  ASSERT_TRUE(vec.is_inline());
+  ASSERT_EQ(vec.capacity(), 4);
+  for (auto i = 0; i < 3; i++) {
+    vec.push_back(std::to_string(i));
+    vec_ref.push_back(std::to_string(i));
+  }
+  vec.insert(vec.begin() + 1, vec[2]);
+  vec_ref.insert(vec_ref.begin() + 1, vec_ref[2]);
+  vec.erase(vec.begin());
+  vec_ref.erase(vec_ref.begin());
+  vec.push_back("3");
+  vec_ref.push_back("3");
+  check_equal(vec, vec_ref);
+  ASSERT_TRUE(vec.is_inline());
+  ASSERT_EQ(counting_allocator<std::string>::allocations, 0);
+
+  // spill to the heap
+  vec.emplace_back("4");
+  vec_ref.emplace_back("4");
+  check_equal(vec, vec_ref);
+  ASSERT_FALSE(vec.is_inline());
+  ASSERT_EQ(counting_allocator<std::string>::allocations, 1);
+  for (auto i = 5; i < 100; i++) {
+    vec.emplace(vec.begin(), std::to_string(i));
+    vec_ref.emplace(vec_ref.begin(), std::to_string(i));
+  }
+  check_equal(vec, vec_ref);
+
+  // back to small
+  vec.clear();
+  vec_ref.clear();
+  auto vec_s = small({"a", "b"});
+  auto vec_s_ref = std::vector<std::string>({"a", "b"});
+  vec = vec_s;
+  vec_ref = vec_s_ref;
+  check_equal(vec, vec_ref);
+  ASSERT_FALSE(vec.is_inline());
+  vec.shrink_to_fit();
+  ASSERT_TRUE(vec.is_inline());
+  ASSERT_EQ(vec.capacity(), 4);
+  check_equal(vec, vec_ref);
+
+  // moving between unequal allocators allocates, so it may throw
+  using pinned = small_vector<std::string, 4, growth::doubling, pinned_allocator<std::string>>;
+  static_assert(std::is_nothrow_move_assignable_v<small>);
+  static_assert(!std::is_nothrow_move_assignable_v<pinned>);
+  auto heap = pinned({"a", "b", "c", "d", "e"});
+  auto target = pinned();
+  target = std::move(heap);
+  ASSERT_EQ(target.size(), 5);
+  ASSERT_EQ(target[4], "e");
+}
+
+TEST(SmallVectorTests, TestModifier) {
+  auto vec = small_vector<int, 8>({1, 2, 3, 4, 5});
+  auto vec_ref = std::vector<int>({1, 2, 3, 4, 5});
+  check_equal(vec, vec_ref);
+
+  vec.push_back(6);
+  vec_ref.push_back(6);
+  vec.pop_back();
+  vec_ref.pop_back();
+  vec.erase(vec.begin(), vec.begin() + 2);
+  vec_ref.erase(vec_ref.begin(), vec_ref.begin() + 2);
+  check_equal(vec, vec_ref);
+
+  vec.insert(vec.begin() + 1, 10, 7);
+  vec_ref.insert(vec_ref.begin() + 1, 10, 7);
+  check_equal(vec, vec_ref);
+  auto vec_i = small_vector<int, 8>({1, 2, 3});
+  vec.insert(vec.begin(), vec_i.begin(), vec_i.end());
+  vec_ref.insert(vec_ref.begin(), {1, 2, 3});
+  check_equal(vec, vec_ref);
+
+  vec.resize(2);
+  vec_ref.resize(2);
+  check_equal(vec, vec_ref);
+  vec.resize(20, 3);
+  vec_ref.resize(20, 3);
+  check_equal(vec, vec_ref);
+  vec.resize(25);
+  vec_ref.resize(25);
+  check_equal(vec, vec_ref);
+
+  vec.reserve(100);
+  ASSERT_EQ(vec.capacity(), 100);
+  check_equal(vec, vec_ref);
+}
+
+TEST(SmallVectorTests, TestMoveAndSwap) {
+  auto small = small_vector<std::string, 2>({"a", "b"});
+  auto large = small_vector<std::string, 2>({"c", "d", "e"});
+  ASSERT_TRUE(small.is_inline());
+  ASSERT_FALSE(large.is_inline());
+
+  // inline elements are moved, heap arrays are stolen
+  auto data = large.data();
+  auto small_m = std::move(small);
+  auto large_m = std::move(large);
+  ASSERT_TRUE(small_m.is_inline());
+  ASSERT_EQ(large_m.data(), data);
+  ASSERT_TRUE(small.empty() && large.empty());
+  ASSERT_TRUE(large.is_inline());
+  check_equal(small_m, {"a", "b"});
+  check_equal(large_m, {"c", "d", "e"});
+
+  small_m.swap(large_m);
+  check_equal(small_m, {"c", "d", "e"});
+  check_equal(large_m, {"a", "b"});
+  large_m.swap(small_m);
+  check_equal(small_m, {"a", "b"});
+  check_equal(large_m, {"c", "d", "e"});
+
+  auto copy = small_m;
+  ASSERT_TRUE(copy == small_m);
+  copy = large_m;
+  ASSERT_TRUE(copy == large_m);
+  ASSERT_TRUE(copy != small_m);
+  copy = std::move(small_m);
+  check_equal(copy, {"a", "b"});
+}
+
+TEST(SmallVectorTests, TestRangeInsert) {
+  // a range of the vector itself, inline, then spilling to the heap
+  auto vec = small_vector<std::string, 8>({"a", "b", "c", "d"});
+  vec.insert(vec.begin() + 1, vec.begin(), vec.end());
+  check_equal(vec, {"a", "a", "b", "c", "d", "b", "c", "d"});
+  ASSERT_TRUE(vec.is_inline());
+  vec.insert(vec.begin() + 1, vec.begin(), vec.begin() + 4);
+  check_equal(vec, {"a", "a", "a", "b", "c", "a", "b", "c", "d", "b", "c", "d"});
+  ASSERT_FALSE(vec.is_inline());
+  auto vec_s = small_vector<std::string, 4>({"a", "b", "c", "d"});
+  vec_s.insert(vec_s.begin() + 1, vec_s.begin(), vec_s.end());
+  check_equal(vec_s, {"a", "a", "b", "c", "d", "b", "c", "d"});
+  vec_s.insert(vec_s.begin(), 3, vec_s[7]);
+  check_equal(vec_s, {"d", "d", "d", "a", "a", "b", "c", "d", "b", "c", "d"});
+
+  // other iterators, single pass ones included
+  auto nums = small_vector<int, 4>({1, 2});
+  auto more = std::vector<int>({3, 4, 5});
+  nums.append(more.begin(), more.end());
+  check_equal(nums, {1, 2, 3, 4, 5});
+  auto in = std::istringstream("7 8 9");
+  nums.insert(nums.begin() + 1, std::istream_iterator<int>(in), std::istream_iterator<int>());
+  check_equal(nums, {1, 7, 8, 9, 2, 3, 4, 5});
+  nums.append(more.end(), more.end());
+  check_equal(nums, {1, 7, 8, 9, 2, 3, 4, 5});
+
+  nums.assign(nums.begin() + 5, nums.end());
+  check_equal(nums, {3, 4, 5});
+  nums.assign(more.begin(), more.begin() + 2);
+  check_equal(nums, {3, 4});
+  auto in2 = std::istringstream("4 5");
+  nums.assign(std::istream_iterator<int>(in2), std::istream_iterator<int>());
+  check_equal(nums, {4, 5});
+}
+
+TEST(SmallVectorTests, TestSearch) {
+  auto vec = small_vector<int, 16>();
+  auto vec_ref = std::vector<int>();
+  for (auto i = 0; i < 1000; i++) {
+    vec.push_back(i % 97);
+    vec_ref.push_back(i % 97);
+  }
+  for (auto v : {0, 42, 96, 97, -1}) {
+    ASSERT_EQ(vec.find(v) - vec.begin(), std::find(vec_ref.begin(), vec_ref.end(), v) - vec_ref.begin());
+    ASSERT_EQ(vec.count(v), std::count(vec_ref.begin(), vec_ref.end(), v));
+    ASSERT_EQ(vec.contains(v), std::find(vec_ref.begin(), vec_ref.end(), v) != vec_ref.end());
+  }
+
+  vec[500] = -5;
+  vec[600] = 200;
+  ASSERT_EQ(vec.min_element() - vec.begin(), 500);
+  ASSERT_EQ(vec.max_element() - vec.begin(), 600);
+  auto vec_c = vec;
+  ASSERT_TRUE(vec_c == vec);
+  vec_c[999] = -1;
+  ASSERT_TRUE(vec_c != vec);
+
+  auto strs = small_vector<std::string, 4>({"a", "b", "a"});
+  ASSERT_EQ(strs.find("b"), strs.begin() + 1);
+  ASSERT_EQ(strs.count("a"), 2);
+  ASSERT_FALSE(strs.contains("c"));
+  auto empty = small_vector<int, 4>();
+  ASSERT_EQ(empty.find(0), empty.end());
+  ASSERT_EQ(empty.min_element(), empty.end());
+}
+
+// a copy throws once copies_left reaches 0
+struct throw_on_copy {
+  static inline int copies_left = -1;
+
+  std::string s_;
+
+  explicit throw_on_copy(std::string s) : s_(std::move(s)) {}
+  throw_on_copy(const throw_on_copy &other) : s_(other.s_) {
+    if (copies_left == 0) {
+      throw std::exception();
+    }
+    copies_left--;
+  }
+  throw_on_copy(throw_on_copy &&other) noexcept = default;
+  throw_on_copy &operator=(const throw_on_copy &other) = default;
+};
+
+TEST(SmallVectorTests, TestExceptionSafety) {
+  auto vec = small_vector<throw_on_copy, 4>();
+  for (auto i = 0; i < 4; i++) {
+    vec.emplace_back(std::string(50, 'a' + i));
+  }
+  auto src = std::vector<throw_on_copy>(3, throw_on_copy(std::string(50, 'x')));
+  auto value = throw_on_copy(std::string(50, 'y'));
+  // a failed insertion leaves the vector as it was, on the heap or inline, with and without reallocation
+  for (auto spare : {0, 100}) {
+    vec.reserve(vec.size() + spare);
+    throw_on_copy::copies_left = 1;
+    ASSERT_THROW(vec.insert(vec.begin() + 1, src.begin(), src.end()), std::exception);
+    throw_on_copy::copies_left = 1;
+    ASSERT_THROW(vec.insert(vec.begin() + 1, 3, value), std::exception);
+    throw_on_copy::copies_left = 0;
+    ASSERT_THROW(vec.insert(vec.begin() + 1, value), std::exception);
+    ASSERT_EQ(vec.size(), 4);
+    for (auto i = 0; i < 4; i++) {
+      ASSERT_EQ(vec[i].s_, std::string(50, 'a' + i));
+    }
+  }
+  throw_on_copy::copies_left = 0;
+  vec.shrink_to_fit();
+  ASSERT_THROW(vec.push_back(value), std::exception);
+  ASSERT_EQ(vec.size(), 4);
+  throw_on_copy::copies_left = -1;
+}
+
+}  // namespace STL
@@ -39,6 +39,12 @@ TEST(StringTests, TestAll) {
   string str7 = std::move(str5);
   std::string str7_ref = std::move(str5_ref);
   check_equal(str7, str7_ref);
+
+  // a moved-from string views and hashes as empty
+  ASSERT_TRUE(std::string_view(str5).empty());
+  ASSERT_EQ(str5.size(), 0);
+  ASSERT_EQ(str5, std::string_view());
+  ASSERT_EQ(string_hash()(str5), string_hash()(""));
 }
 
 }  // namespace STL
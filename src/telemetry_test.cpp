@@ -0,0 +1,76 @@
+#include "include/telemetry.h"
+#include <gtest/gtest.h>
+#include <sstream>
+#include "include/string.h"
+#include "include/vector.h"
+
+namespace STL {
+
+template <typename T>
+using tracked_vector = vector<T, growth::doubling, std::allocator<T>, telemetry::on>;
+
+telemetry::snapshot find_snapshot(const std::string &type) {
+  for (auto &snap : telemetry::collect()) {
+    if (snap.type == type) {
+      return snap;
+    }
+  }
+  return telemetry::snapshot();
+}
+
+TEST(TelemetryTests, TestVector) {
+  using ints = tracked_vector<int>;
+  auto type = telemetry::type_name(typeid(ints));
+  {
+    auto vec = ints();
+    for (auto i = 0; i < 100; i++) {
+      vec.push_back(i);
+    }
+    auto snap = find_snapshot(type);
+    ASSERT_EQ(snap.instances, 1);
+    ASSERT_EQ(snap.bytes_used, 100 * sizeof(int));
+    ASSERT_EQ(snap.bytes_reserved, 128 * sizeof(int));
+    // 1, 2, 4, ..., 128
+    ASSERT_EQ(snap.reallocations, 8);
+    ASSERT_EQ(snap.bytes_copied, (1 + 2 + 4 + 8 + 16 + 32 + 64) * sizeof(int));
+
+    auto vec_c = vec;
+    vec.clear();
+    snap = find_snapshot(type);
+    ASSERT_EQ(snap.instances, 2);
+    ASSERT_EQ(snap.bytes_used, 100 * sizeof(int));
+    ASSERT_EQ(snap.bytes_reserved, 128 * sizeof(int) + vec_c.capacity() * sizeof(int));
+
+    vec.shrink_to_fit();
+    snap = find_snapshot(type);
+    ASSERT_EQ(snap.bytes_reserved, vec_c.capacity() * sizeof(int));
+    ASSERT_EQ(snap.reallocations, 9);
+  }
+  auto snap = find_snapshot(type);
+  ASSERT_EQ(snap.instances, 0);
+  ASSERT_EQ(snap.bytes_reserved, 0);
+}
+
+TEST(TelemetryTests, TestReport) {
+  // nested vectors are moved one by one and stay registered at their new address
+  auto vecs = vector<tracked_vector<string>>();
+  for (auto i = 0; i < 10; i++) {
+    vecs.emplace_back(3, string("abc"));
+  }
+  auto snap = find_snapshot(telemetry::type_name(typeid(tracked_vector<string>)));
+  ASSERT_EQ(snap.instances, 10);
+  ASSERT_EQ(snap.bytes_used, 30 * sizeof(string));
+
+  auto os = std::ostringstream();
+  telemetry::report(os);
+  ASSERT_NE(os.str().find("instances(10)"), std::string::npos);
+
+  // the default records nothing and costs no room
+  static_assert(std::is_empty_v<telemetry::off::probe<vector<int>>>);
+  static_assert(sizeof(vector<int>) < sizeof(tracked_vector<int>));
+  static_assert(is_trivially_relocatable_v<vector<int>>);
+  static_assert(!is_trivially_relocatable_v<tracked_vector<int>>);
+  ASSERT_EQ(find_snapshot(telemetry::type_name(typeid(vector<string>))).instances, 0);
+}
+
+}  // namespace STL
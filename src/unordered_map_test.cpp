@@ -1,6 +1,13 @@
 #include "include/unordered_map.h"
+#include "include/string.h"
 #include <gtest/gtest.h>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace STL {
 
@@ -99,6 +106,9 @@ TEST(UnorderedMapTests, TestObserver) {
 
   ASSERT_NE(map.find(std::string("c")), map.end());
   ASSERT_EQ(map.find(std::string("d")), map.end());
+  const auto &map_c = map;
+  ASSERT_EQ(map_c.find(std::string("c"))->second, 3);
+  ASSERT_EQ(map_c.find(std::string("d")), map_c.end());
 
   ASSERT_EQ(map.count(std::string("c")), map_ref.count(std::string("c")));
   ASSERT_EQ(map.count(std::string("d")), map_ref.count(std::string("d")));
@@ -114,4 +124,337 @@ TEST(UnorderedMapTests, TestObserver) {
   check_equal(map, map_ref);
 }
 
+TEST(UnorderedMapTests, TestIncrementalRehash) {
+  auto map = unordered_map<int, int>();
+  auto map_ref = std::unordered_map<int, int>();
+  map.incremental_rehash(true);
+  ASSERT_TRUE(map.incremental_rehash());
+  auto rehashes = 0;
+  for (auto i = 0; i < 20000; i++) {
+    auto count = map.bucket_count();
+    map.insert({i, i});
+    map_ref.insert({i, i});
+    if (map.bucket_count() != count) {
+      // the insert that crossed the load factor only started the rehash
+      ASSERT_TRUE(map.rehashing() || count <= (unordered_map<int, int>::rehash_step));
+      if (map.rehashing()) {
+        // the new table is built by the following steps, its bucket sizes count the entries left in the old one
+        size_t counted = 0;
+        for (size_t n = 0; n < map.bucket_count(); n++) {
+          counted += map.bucket_size(n);
+        }
+        ASSERT_EQ(counted, map.size());
+      }
+      rehashes++;
+    }
+    if (map.rehashing() && i % 3 == 0) {
+      // lookups and erasures see both tables
+      ASSERT_EQ(map.at(i / 2), i / 2);
+      ASSERT_EQ(std::as_const(map).find(i / 2)->second, i / 2);
+      ASSERT_EQ(map.find(i + 1), map.end());
+      map.erase(map.find(i / 3));
+      map_ref.erase(i / 3);
+      map[i / 3] = i / 3;
+      map_ref[i / 3] = i / 3;
+    }
+  }
+  ASSERT_GT(rehashes, 10);
+  check_equal(map, map_ref);
+  for (auto &kv : map_ref) {
+    ASSERT_EQ(map.at(kv.first), kv.second);
+  }
+
+  // copies, moves and swaps in the middle of a rehash
+  while (!map.rehashing()) {
+    map.insert({static_cast<int>(map.size()), 0});
+    map_ref.insert({static_cast<int>(map_ref.size()), 0});
+  }
+  auto map_c = map;
+  ASSERT_FALSE(map_c.rehashing());
+  check_equal(map_c, map_ref);
+  auto map_m = std::move(map);
+  ASSERT_TRUE(map_m.rehashing());
+  check_equal(map_m, map_ref);
+  map.swap(map_m);
+  ASSERT_TRUE(map.rehashing());
+  for (auto &kv : map_ref) {
+    ASSERT_EQ(map.at(kv.first), kv.second);
+  }
+  map.rehash(map.bucket_count());
+  ASSERT_FALSE(map.rehashing());
+  check_equal(map, map_ref);
+  map.clear();
+  ASSERT_TRUE(map.empty());
+
+  // clear in the middle of a rehash, before and after the new table is built
+  for (auto steps : {size_t(0), map.bucket_count()}) {
+    for (auto i = 2; !map.rehashing(); i++) {
+      map.insert({i, 0});
+    }
+    for (size_t i = 0; i < steps && map.rehashing(); i++) {
+      map.insert({-static_cast<int>(i) - 1, 0});
+    }
+    map.clear();
+    ASSERT_TRUE(map.empty());
+    ASSERT_FALSE(map.rehashing());
+    for (size_t n = 0; n < map.bucket_count(); n++) {
+      ASSERT_EQ(map.bucket_size(n), 0);
+    }
+    map.insert({1, 1});
+    ASSERT_EQ(map.at(1), 1);
+  }
+}
+
+// std::hash, counting its calls
+struct counting_hash {
+  static inline size_t calls = 0;
+
+  size_t operator()(const std::string &key) const {
+    calls++;
+    return std::hash<std::string>()(key);
+  }
+};
+
+// compares the hash of keys, counting the key comparisons
+struct counted_key {
+  static inline size_t compares = 0;
+
+  int v_;
+
+  bool operator==(const counted_key &other) const {
+    compares++;
+    return v_ == other.v_;
+  }
+};
+
+struct counted_key_hash {
+  size_t operator()(const counted_key &key) const { return key.v_; }
+};
+
+TEST(UnorderedMapTests, TestCachedHash) {
+  auto map = unordered_map<std::string, int, counting_hash>();
+  for (auto i = 0; i < 1000; i++) {
+    map.insert({std::to_string(i), i});
+  }
+  // one hash per insert, none for the rehashes on the way
+  ASSERT_EQ(counting_hash::calls, 1000);
+  map.rehash(map.bucket_count() * 4);
+  map.reserve(10000);
+  ASSERT_EQ(counting_hash::calls, 1000);
+  for (auto i = 0; i < 1000; i++) {
+    ASSERT_EQ(map.at(std::to_string(i)), i);
+  }
+  ASSERT_EQ(counting_hash::calls, 2000);
+
+  map.incremental_rehash(true);
+  for (auto i = 1000; i < 20000; i++) {
+    map.insert({std::to_string(i), i});
+  }
+  ASSERT_EQ(counting_hash::calls, 21000);
+
+  // erasures and copies reuse the hashes kept with the entries, during a rehash as well
+  while (!map.rehashing()) {
+    map.insert({std::to_string(map.size()), 0});
+  }
+  counting_hash::calls = 0;
+  map.erase(map.find("7"));
+  map.erase(map.begin());
+  auto copy = map;
+  ASSERT_EQ(counting_hash::calls, 1);
+  ASSERT_EQ(copy.size(), map.size());
+  ASSERT_EQ(copy.count("7"), 0);
+  ASSERT_EQ(copy.at("8"), 8);
+
+  // keys sharing a bucket are compared only when their hashes are equal
+  auto keys = unordered_map<counted_key, int, counted_key_hash>(4);
+  keys.max_load_factor(100);
+  for (auto i = 0; i < 100; i++) {
+    keys.insert({counted_key{i}, i});
+  }
+  ASSERT_EQ(counted_key::compares, 0);
+  ASSERT_EQ(keys.at(counted_key{42}), 42);
+  ASSERT_EQ(counted_key::compares, 1);
+  ASSERT_EQ(keys.count(counted_key{1000}), 0);
+  ASSERT_EQ(counted_key::compares, 1);
+}
+
+// counts its constructions
+struct counted_value {
+  static inline int constructed = 0;
+
+  int v_;
+
+  counted_value() : v_(0) { constructed++; }
+  explicit counted_value(int v) : v_(v) { constructed++; }
+  counted_value(const counted_value &other) : v_(other.v_) { constructed++; }
+  counted_value &operator=(const counted_value &other) = default;
+};
+
+TEST(UnorderedMapTests, TestEmplace) {
+  counting_hash::calls = 0;
+  auto map = unordered_map<std::string, counted_value, counting_hash>();
+
+  // one hash per operation, values constructed in place and only when inserted
+  auto [itr, inserted] = map.try_emplace("a", 1);
+  ASSERT_TRUE(inserted);
+  ASSERT_EQ(itr->second.v_, 1);
+  ASSERT_EQ(counted_value::constructed, 1);
+  std::tie(itr, inserted) = map.try_emplace("a", 2);
+  ASSERT_FALSE(inserted);
+  ASSERT_EQ(itr->second.v_, 1);
+  ASSERT_EQ(counted_value::constructed, 1);
+  ASSERT_EQ(counting_hash::calls, 2);
+
+  map["b"].v_ = 2;
+  ASSERT_EQ(counted_value::constructed, 2);
+  map["b"].v_++;
+  ASSERT_EQ(map.at("b").v_, 3);
+  ASSERT_EQ(counting_hash::calls, 5);
+
+  std::tie(itr, inserted) = map.insert_or_assign("b", counted_value(4));
+  ASSERT_FALSE(inserted);
+  ASSERT_EQ(itr->second.v_, 4);
+  std::tie(itr, inserted) = map.insert_or_assign("c", counted_value(5));
+  ASSERT_TRUE(inserted);
+  ASSERT_EQ(map.at("c").v_, 5);
+
+  std::tie(itr, inserted) = map.emplace(std::piecewise_construct, std::forward_as_tuple("d"), std::forward_as_tuple(6));
+  ASSERT_TRUE(inserted);
+  std::tie(itr, inserted) = map.emplace("d", counted_value(7));
+  ASSERT_FALSE(inserted);
+  ASSERT_EQ(itr->second.v_, 6);
+  std::tie(itr, inserted) = map.insert({"e", counted_value(8)});
+  ASSERT_TRUE(inserted);
+  std::tie(itr, inserted) = map.insert({"e", counted_value(9)});
+  ASSERT_FALSE(inserted);
+  ASSERT_EQ(itr->second.v_, 8);
+  ASSERT_EQ(map.size(), 5);
+
+  // move-only values
+  auto ptrs = unordered_map<int, std::unique_ptr<int>>();
+  ptrs.try_emplace(1, std::make_unique<int>(1));
+  ptrs.insert_or_assign(1, std::make_unique<int>(2));
+  ptrs[2] = std::make_unique<int>(3);
+  ptrs.emplace(3, std::make_unique<int>(4));
+  ASSERT_EQ(*ptrs.at(1), 2);
+  ASSERT_EQ(*ptrs.at(2), 3);
+  ASSERT_EQ(*ptrs.at(3), 4);
+}
+
+// a string key counting its constructions, hashed by string_hash
+struct counted_string {
+  static inline int constructed = 0;
+
+  std::string str_;
+
+  explicit counted_string(std::string_view sv) : str_(sv) { constructed++; }
+  counted_string(const counted_string &other) : str_(other.str_) { constructed++; }
+
+  operator std::string_view() const { return str_; }
+  bool operator==(std::string_view sv) const { return str_ == sv; }
+  bool operator==(const counted_string &other) const { return str_ == other.str_; }
+};
+
+TEST(UnorderedMapTests, TestTransparent) {
+  auto map = unordered_map<counted_string, int, string_hash>();
+  for (auto i = 0; i < 100; i++) {
+    map.try_emplace(counted_string(std::to_string(i)), i);
+  }
+  counted_string::constructed = 0;
+
+  // looked up by view, by C string or by a slice of a buffer: no key is built
+  ASSERT_EQ(map.at(std::string_view("42")), 42);
+  ASSERT_EQ(map.find("7")->second, 7);
+  auto buf = "1234";
+  ASSERT_EQ(map.count(std::string_view(buf, 2)), 1);
+  ASSERT_EQ(map.at(std::string_view(buf + 1, 2)), 23);
+  ASSERT_EQ(map.count(std::string_view(buf, 3)), 0);
+  ASSERT_TRUE(map.find(std::string_view("100")) == map.end());
+  ASSERT_THROW(map.at(std::string_view("-1")), std::exception);
+  map[std::string_view("5")] = 50;
+  ASSERT_EQ(map.at("5"), 50);
+  ASSERT_EQ(counted_string::constructed, 0);
+
+  // operator[] builds a key only for a new entry
+  map[std::string_view("100")] = 100;
+  ASSERT_EQ(counted_string::constructed, 1);
+  ASSERT_EQ(map.size(), 101);
+
+  // STL::string keys
+  auto strs = unordered_map<string, int, string_hash>();
+  strs[string("abc")] = 1;
+  strs["de"] = 2;
+  ASSERT_EQ(strs.at(std::string_view("abcd", 3)), 1);
+  ASSERT_EQ(strs.at(std::string("de")), 2);
+  ASSERT_EQ(strs.at(string("de")), 2);
+  ASSERT_EQ(strs.count("d"), 0);
+  ASSERT_EQ(string_hash()(string("abc")), string_hash()("abc"));
+  ASSERT_EQ(string_hash()(std::string("abc")), string_hash()(std::string_view("abcd", 3)));
+}
+
+TEST(UnorderedMapTests, TestBatch) {
+  auto map = unordered_map<std::string, int>();
+  auto pairs = std::vector<std::pair<std::string, int>>();
+  for (auto i = 0; i < 1000; i++) {
+    pairs.emplace_back(std::to_string(i % 700), i);
+  }
+  // the first pair of a key wins, as with insert
+  ASSERT_EQ(map.insert_batch(pairs), 700);
+  ASSERT_EQ(map.size(), 700);
+  ASSERT_EQ(map.at("1"), 1);
+  ASSERT_EQ(map.insert_batch(pairs.begin(), pairs.begin() + 10), 0);
+
+  // any forward iterator: the length is counted first
+  auto lst = list<std::pair<std::string, int>>();
+  for (auto i = 690; i < 720; i++) {
+    lst.push_back({std::to_string(i), i});
+  }
+  ASSERT_EQ(map.insert_batch(lst.begin(), lst.end()), 20);
+  ASSERT_EQ(map.at("719"), 719);
+  auto erased = std::vector<unordered_map<std::string, int>::iterator>();
+  for (auto i = 700; i < 720; i++) {
+    erased.push_back(map.find(std::to_string(i)));
+  }
+  for (auto itr : erased) {
+    map.erase(itr);
+  }
+  ASSERT_EQ(map.size(), 700);
+
+  auto keys = std::vector<std::string>();
+  for (auto i = 0; i < 1000; i += 3) {
+    keys.push_back(std::to_string(i));
+  }
+  auto found = std::vector<unordered_map<std::string, int>::iterator>();
+  ASSERT_EQ(map.find_batch(keys, std::back_inserter(found)), 234);
+  ASSERT_EQ(found.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (i * 3 < 700) {
+      ASSERT_EQ(found[i]->first, keys[i]);
+      ASSERT_EQ(found[i]->second, i * 3);
+    } else {
+      ASSERT_TRUE(found[i] == map.end());
+    }
+  }
+
+  // while an incremental rehash is in progress, keys are found in either table
+  auto grown = unordered_map<int, int>();
+  grown.incremental_rehash(true);
+  auto ints = std::vector<std::pair<int, int>>();
+  for (auto i = 0; i < 2000; i++) {
+    ints.emplace_back(i, -i);
+  }
+  ASSERT_EQ(grown.insert_batch(ints.begin(), ints.begin() + 1000), 1000);
+  for (auto i = 1000; !grown.rehashing(); i++) {
+    grown.insert({i, -i});
+  }
+  auto ids = std::vector<int>({5, 999, 3000, 0, 1500});
+  auto out = std::vector<unordered_map<int, int>::iterator>(ids.size());
+  auto expected = grown.count(1500) + 3;
+  ASSERT_EQ(grown.find_batch(ids.begin(), ids.end(), out.begin()), expected);
+  ASSERT_EQ(out[0]->second, -5);
+  ASSERT_EQ(out[1]->second, -999);
+  ASSERT_TRUE(out[2] == grown.end());
+  ASSERT_EQ(out[3]->second, 0);
+}
+
 }  // namespace STL
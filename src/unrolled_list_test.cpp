@@ -0,0 +1,177 @@
+#include "include/unrolled_list.h"
+#include <gtest/gtest.h>
+#include <list>
+#include <random>
+#include <string>
+
+namespace STL {
+
+template <typename T, size_t K>
+void check_equal(const unrolled_list<T, K> &lst, const std::list<T> &lst_ref) {
+  ASSERT_EQ(lst.size(), lst_ref.size());
+  auto itr_ref = lst_ref.begin();
+  for (auto itr = lst.begin(); itr != lst.end(); itr++, itr_ref++) {
+    ASSERT_EQ(*itr, *itr_ref);
+  }
+  // and backwards
+  auto ritr_ref = lst_ref.rbegin();
+  for (auto itr = lst.end(); itr != lst.begin();) {
+    --itr;
+    ASSERT_EQ(*itr, *ritr_ref);
+    ritr_ref++;
+  }
+}
+
+TEST(UnrolledListTests, TestConstructor) {
+  auto lst1 = unrolled_list<int, 4>();
+  ASSERT_TRUE(lst1.empty());
+  ASSERT_EQ(lst1.begin(), lst1.end());
+
+  auto lst2 = unrolled_list<int, 4>({1, 2, 3, 4, 5, 6, 7, 8, 9});
+  auto lst2_ref = std::list<int>({1, 2, 3, 4, 5, 6, 7, 8, 9});
+  check_equal(lst2, lst2_ref);
+
+  auto lst3 = lst2;
+  ASSERT_TRUE(lst3 == lst2);
+  auto lst4 = std::move(lst2);
+  ASSERT_TRUE(lst2.empty());
+  ASSERT_TRUE(lst3 == lst4);
+  lst2 = lst4;
+  ASSERT_TRUE(lst2 == lst4);
+  lst1 = std::move(lst4);
+  check_equal(lst1, lst2_ref);
+  lst1.swap(lst4);
+  ASSERT_TRUE(lst1.empty());
+  check_equal(lst4, lst2_ref);
+  lst4.push_back(10);
+  ASSERT_TRUE(lst4 != lst2);
+}
+
+TEST(UnrolledListTests, TestModifier) {
+  auto lst = unrolled_list<std::string, 4>();
+  auto lst_ref = std::list<std::string>();
+  for (auto i = 0; i < 20; i++) {
+    lst.push_back(std::to_string(i));
+    lst_ref.push_back(std::to_string(i));
+    lst.push_front(std::to_string(-i));
+    lst_ref.push_front(std::to_string(-i));
+  }
+  check_equal(lst, lst_ref);
+  lst.pop_back();
+  lst_ref.pop_back();
+  lst.pop_front();
+  lst_ref.pop_front();
+  check_equal(lst, lst_ref);
+
+  // insert returns where the element ended up, erase the element after the erased one
+  auto itr = lst.begin();
+  auto itr_ref = lst_ref.begin();
+  for (auto i = 0; i < 7; i++, itr++, itr_ref++) {
+  }
+  itr = lst.insert(itr, "x");
+  itr_ref = lst_ref.insert(itr_ref, "x");
+  ASSERT_EQ(*itr, "x");
+  itr = lst.insert(itr, *itr);
+  itr_ref = lst_ref.insert(itr_ref, *itr_ref);
+  check_equal(lst, lst_ref);
+  itr = lst.erase(itr);
+  itr_ref = lst_ref.erase(itr_ref);
+  ASSERT_EQ(*itr, *itr_ref);
+  check_equal(lst, lst_ref);
+
+  lst.clear();
+  ASSERT_TRUE(lst.empty());
+  lst.push_back("a");
+  ASSERT_EQ(*lst.begin(), "a");
+}
+
+TEST(UnrolledListTests, TestRandom) {
+  auto gen = std::mt19937(7);
+  auto lst = unrolled_list<int, 8>();
+  auto lst_ref = std::list<int>();
+  for (auto round = 0; round < 5000; round++) {
+    auto pos = lst_ref.empty() ? 0 : gen() % (lst_ref.size() + 1);
+    auto itr = lst.begin();
+    auto itr_ref = lst_ref.begin();
+    for (size_t i = 0; i < pos; i++, itr++, itr_ref++) {
+    }
+    if (gen() % 3 != 0 || itr_ref == lst_ref.end()) {
+      itr = lst.insert(itr, round);
+      itr_ref = lst_ref.insert(itr_ref, round);
+      ASSERT_EQ(*itr, round);
+    } else {
+      itr = lst.erase(itr);
+      itr_ref = lst_ref.erase(itr_ref);
+      ASSERT_EQ(itr == lst.end(), itr_ref == lst_ref.end());
+    }
+    if (round % 500 == 0) {
+      check_equal(lst, lst_ref);
+    }
+  }
+  check_equal(lst, lst_ref);
+  while (!lst_ref.empty()) {
+    lst.pop_front();
+    lst_ref.pop_front();
+  }
+  ASSERT_TRUE(lst.empty());
+  ASSERT_EQ(lst.begin(), lst.end());
+}
+
+// copies and moves throw on demand
+struct throwing {
+  static inline bool throw_copy = false;
+  static inline bool throw_move = false;
+
+  std::string s_;
+
+  explicit throwing(std::string s) : s_(std::move(s)) {}
+  throwing(const throwing &other) : s_(other.s_) {
+    if (throw_copy) {
+      throw std::exception();
+    }
+  }
+  throwing(throwing &&other) : s_(std::move(other.s_)) {
+    if (throw_move) {
+      throw std::exception();
+    }
+  }
+};
+
+}  // namespace STL
+
+// relocated with memmove: only the insertion itself moves or copies
+template <>
+struct STL::is_trivially_relocatable<STL::throwing> : std::true_type {};
+
+namespace STL {
+
+TEST(UnrolledListTests, TestExceptionSafety) {
+  auto lst = unrolled_list<throwing, 4>();
+  auto value = throwing(std::string(50, 'x'));
+  // no empty block is left behind by a failed construction
+  throwing::throw_copy = true;
+  ASSERT_THROW(lst.push_back(value), std::exception);
+  ASSERT_EQ(lst.begin(), lst.end());
+  throwing::throw_copy = false;
+  for (auto i = 0; i < 4; i++) {
+    lst.push_back(throwing(std::string(50, 'a' + i)));
+  }
+  throwing::throw_copy = true;
+  ASSERT_THROW(lst.push_back(value), std::exception);
+  ASSERT_EQ(lst.size(), 4);
+  ASSERT_EQ(std::distance(lst.begin(), lst.end()), 4);
+
+  // nor a hole by a failed shift
+  throwing::throw_copy = false;
+  lst.pop_back();
+  throwing::throw_move = true;
+  ASSERT_THROW(lst.insert(std::next(lst.begin()), value), std::exception);
+  throwing::throw_move = false;
+  ASSERT_EQ(lst.size(), 3);
+  auto i = 0;
+  for (auto &v : lst) {
+    ASSERT_EQ(v.s_, std::string(50, 'a' + i++));
+  }
+}
+
+}  // namespace STL
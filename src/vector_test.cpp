@@ -1,6 +1,10 @@
 #include "include/vector.h"
+#include "include/shared_ptr.h"
+#include "include/list.h"
+#include "include/string.h"
 #include <gtest/gtest.h>
 #include <random>
+#include <sstream>
 #include <vector>
 
 namespace STL {
@@ -31,6 +35,7 @@ TEST(VectorTests, TestConstructor) {
     arr2[i] = i;
   }
   auto vec2 = vector(arr2, 5);
+  delete[] arr2;
   vec2.view();
   ASSERT_TRUE(vec2.size() == 5 && vec2.capacity() == 10);
 
@@ -40,6 +45,7 @@ TEST(VectorTests, TestConstructor) {
     arr3[i] = i;
   }
   auto vec3 = vector(arr3, arr3 + 5);
+  delete[] arr3;
   vec3.view();
   ASSERT_TRUE(vec3.size() == 5 && vec3.capacity() == 10);
 
@@ -293,4 +299,468 @@ TEST(VectorTests, TestQSort) {
   check_equal(vec, vec_ref);
 }
 
+// no default constructor, counts every special member call
+struct Tracked {
+  static inline int alive = 0;
+  static inline int copies = 0;
+  static inline int moves = 0;
+
+  int val_;
+
+  explicit Tracked(int val) : val_(val) { alive++; }
+  Tracked(const Tracked &other) : val_(other.val_) {
+    alive++;
+    copies++;
+  }
+  Tracked(Tracked &&other) noexcept : val_(other.val_) {
+    alive++;
+    moves++;
+  }
+  ~Tracked() { alive--; }
+  Tracked &operator=(const Tracked &other) = default;
+  Tracked &operator=(Tracked &&other) noexcept = default;
+  bool operator!=(const Tracked &other) const { return val_ != other.val_; }
+
+  static void reset() { alive = copies = moves = 0; }
+};
+
+TEST(VectorTests, TestRawStorage) {
+  Tracked::reset();
+  {
+    auto vec = vector<Tracked>();
+    for (auto i = 0; i < 100; i++) {
+      vec.push_back(Tracked(i));
+    }
+    // only the pushed elements are alive, spare capacity holds no objects
+    ASSERT_EQ(Tracked::alive, 100);
+    // each push moves once, growth moves instead of copying
+    ASSERT_EQ(Tracked::copies, 0);
+    ASSERT_GT(Tracked::moves, 100);
+    for (auto i = 0; i < 100; i++) {
+      ASSERT_EQ(vec[i].val_, i);
+    }
+
+    // push an element of the vector itself while it grows
+    auto full = vector<Tracked>();
+    full.push_back(Tracked(1));
+    ASSERT_EQ(full.size(), full.capacity());
+    full.push_back(full[0]);
+    ASSERT_EQ(full[1].val_, 1);
+    full.clear();
+
+    vec.insert(vec.begin(), vec[50]);
+    vec.insert(vec.begin() + 10, 3, Tracked(-1));
+    ASSERT_EQ(vec[0].val_, 50);
+    ASSERT_EQ(vec[10].val_, -1);
+    ASSERT_EQ(vec[13].val_, 9);
+    ASSERT_EQ(Tracked::alive, 104);
+
+    vec.erase(vec.begin() + 10, vec.begin() + 13);
+    vec.erase(vec.begin());
+    ASSERT_EQ(Tracked::alive, 100);
+    for (auto i = 0; i < 100; i++) {
+      ASSERT_EQ(vec[i].val_, i);
+    }
+
+    vec.pop_back();
+    vec.resize(10, Tracked(0));
+    ASSERT_EQ(Tracked::alive, 10);
+    vec.clear();
+    ASSERT_EQ(Tracked::alive, 0);
+    vec.resize(20, Tracked(7));
+    ASSERT_EQ(Tracked::alive, 20);
+  }
+  ASSERT_EQ(Tracked::alive, 0);
+}
+
+// same as Tracked, but opted into bulk relocation
+struct Relocatable : Tracked {
+  using Tracked::Tracked;
+};
+
+template <>
+struct is_trivially_relocatable<Relocatable> : std::true_type {};
+
+TEST(VectorTests, TestTriviallyRelocatable) {
+  static_assert(is_trivially_relocatable_v<int>);
+  static_assert(is_trivially_relocatable_v<string>);
+  static_assert(is_trivially_relocatable_v<shared_ptr<int>>);
+  static_assert(is_trivially_relocatable_v<vector<string>>);
+  static_assert(!is_trivially_relocatable_v<Tracked>);
+  static_assert(is_trivially_relocatable_v<Relocatable>);
+
+  Tracked::reset();
+  {
+    auto vec = vector<Relocatable>();
+    auto vec_ref = std::vector<int>();
+    for (auto i = 0; i < 100; i++) {
+      vec.push_back(Relocatable(i));
+      vec_ref.push_back(i);
+    }
+    vec.insert(vec.begin() + 50, Relocatable(-1));
+    vec_ref.insert(vec_ref.begin() + 50, -1);
+    vec.insert(vec.begin() + 1, 200, Relocatable(-2));
+    vec_ref.insert(vec_ref.begin() + 1, 200, -2);
+    vec.erase(vec.begin() + 20, vec.begin() + 60);
+    vec_ref.erase(vec_ref.begin() + 20, vec_ref.begin() + 60);
+    vec.erase(vec.begin());
+    vec_ref.erase(vec_ref.begin());
+
+    // growth and shifting are bulk byte moves, only the pushes move
+    ASSERT_EQ(Tracked::moves, 100);
+    ASSERT_EQ(Tracked::copies, 1 + 200);
+    ASSERT_EQ(Tracked::alive, static_cast<int>(vec_ref.size()));
+    ASSERT_EQ(vec.size(), vec_ref.size());
+    for (size_t i = 0; i < vec.size(); i++) {
+      ASSERT_EQ(vec[i].val_, vec_ref[i]);
+    }
+  }
+  ASSERT_EQ(Tracked::alive, 0);
+
+  auto strs = vector<string>();
+  for (auto i = 0; i < 100; i++) {
+    strs.push_back(string(std::to_string(i).c_str()));
+  }
+  strs.insert(strs.begin(), string("first"));
+  strs.erase(strs.begin() + 1);
+  ASSERT_EQ(strs[0], string("first"));
+  ASSERT_EQ(strs[99], string("99"));
+}
+
+TEST(VectorTests, TestEmplace) {
+  Tracked::reset();
+  {
+    auto vec = vector<Tracked>();
+    vec.reserve(16);
+    for (auto i = 0; i < 8; i++) {
+      ASSERT_EQ(vec.emplace_back(i).val_, i);
+    }
+    // constructed in place
+    ASSERT_EQ(Tracked::copies + Tracked::moves, 0);
+
+    vec.push_back(Tracked(8));
+    ASSERT_EQ(Tracked::copies, 0);
+    ASSERT_EQ(Tracked::moves, 1);
+
+    auto itr = vec.emplace(vec.begin() + 2, -1);
+    ASSERT_EQ(itr, vec.begin() + 2);
+    ASSERT_EQ(vec[2].val_, -1);
+    ASSERT_EQ(vec[3].val_, 2);
+    itr = vec.emplace(vec.end(), 9);
+    ASSERT_EQ(itr->val_, 9);
+    ASSERT_EQ(Tracked::copies, 0);
+
+    // emplace an element of the vector itself, with and without reallocation
+    vec.emplace(vec.begin(), vec[5]);
+    ASSERT_EQ(vec[0].val_, 4);
+    ASSERT_EQ(vec[6].val_, 4);
+    while (vec.size() < vec.capacity()) {
+      vec.emplace_back(0);
+    }
+    vec.emplace(vec.begin() + 1, vec[0]);
+    vec.emplace_back(vec[1]);
+    ASSERT_EQ(vec[1].val_, 4);
+    ASSERT_EQ(vec[vec.size() - 1].val_, 4);
+    ASSERT_EQ(Tracked::alive, static_cast<int>(vec.size()));
+  }
+  ASSERT_EQ(Tracked::alive, 0);
+
+  auto strs = vector<string>();
+  auto str = string("moved");
+  strs.push_back(std::move(str));
+  strs.emplace_back("emplaced");
+  strs.emplace(strs.begin(), "first");
+  ASSERT_EQ(str.c_str(), nullptr);
+  ASSERT_EQ(strs[0], string("first"));
+  ASSERT_EQ(strs[1], string("moved"));
+  ASSERT_EQ(strs[2], string("emplaced"));
+
+  auto ptrs = vector<shared_ptr<int>>();
+  auto ptr = shared_ptr<int>(new int(1));
+  ptrs.push_back(ptr);
+  ptrs.push_back(std::move(ptr));
+  ASSERT_EQ(ptrs[0].use_count(), 2);
+}
+
+TEST(VectorTests, TestGrowthPolicy) {
+  auto vec1 = vector<int, growth::one_and_half>();
+  auto caps = std::vector<size_t>();
+  for (auto i = 0; i < 20; i++) {
+    vec1.push_back(i);
+    if (caps.empty() || caps.back() != vec1.capacity()) {
+      caps.push_back(vec1.capacity());
+    }
+  }
+  ASSERT_EQ(caps, std::vector<size_t>({1, 2, 3, 5, 8, 12, 18, 27}));
+
+  // large buffers are rounded to whole pages
+  auto vec2 = vector<double, growth::page_rounded<4096>>();
+  for (auto i = 0; i < 10000; i++) {
+    vec2.push_back(i);
+    if (vec2.capacity() * sizeof(double) >= 4096) {
+      ASSERT_EQ(vec2.capacity() * sizeof(double) % 4096, 0);
+    }
+  }
+  auto vec3 = vector<char, growth::hugepage_rounded<>>();
+  vec3.resize(3 * 1024 * 1024);
+  ASSERT_EQ(vec3.capacity(), 4 * 1024 * 1024);
+
+  // reserve reallocates exactly once to exactly the requested capacity
+  auto vec4 = vector<int>({1, 2, 3});
+  auto data = vec4.data();
+  vec4.reserve(1000);
+  ASSERT_NE(vec4.data(), data);
+  ASSERT_EQ(vec4.capacity(), 1000);
+  data = vec4.data();
+  vec4.reserve(10);
+  vec4.resize(1000);
+  ASSERT_EQ(vec4.data(), data);
+  vec4.resize(1001);
+  ASSERT_EQ(vec4.capacity(), 2000);
+  ASSERT_EQ(vec4[2], 3);
+
+  // growth jumps straight to the required capacity
+  auto vec5 = vector<int>();
+  vec5.insert(vec5.begin(), 100, 1);
+  ASSERT_EQ(vec5.capacity(), 100);
+}
+
+TEST(VectorTests, TestRangeInsert) {
+  auto vec = vector<int>({1, 2, 3});
+  auto vec_ref = std::vector<int>({1, 2, 3});
+
+  // list iterators are bidirectional: the length is counted first and the buffer grows once
+  auto lst = list<int>();
+  for (auto i = 0; i < 10000; i++) {
+    lst.push_back(i);
+    vec_ref.insert(vec_ref.end() - 1, i);
+  }
+  vec.insert(vec.end() - 1, lst.begin(), lst.end());
+  ASSERT_EQ(vec.capacity(), 10003);
+  check_equal(vec, vec_ref);
+
+  // single pass input iterators
+  auto in = std::istringstream("7 8 9");
+  vec.insert(vec.begin() + 1, std::istream_iterator<int>(in), std::istream_iterator<int>());
+  vec_ref.insert(vec_ref.begin() + 1, {7, 8, 9});
+  check_equal(vec, vec_ref);
+
+  auto more = std::vector<int>({-1, -2});
+  vec.append(more.begin(), more.end());
+  vec_ref.insert(vec_ref.end(), more.begin(), more.end());
+  check_equal(vec, vec_ref);
+  vec.append(more.end(), more.end());
+  check_equal(vec, vec_ref);
+
+  // a range of the vector itself, with and without reallocation
+  vec.reserve(vec.size() + 10);
+  vec.insert(vec.begin(), vec.begin() + 2, vec.begin() + 12);
+  auto part = std::vector<int>(vec_ref.begin() + 2, vec_ref.begin() + 12);
+  vec_ref.insert(vec_ref.begin(), part.begin(), part.end());
+  check_equal(vec, vec_ref);
+  vec.insert(vec.begin(), vec.end() - 5, vec.end());
+  part = std::vector<int>(vec_ref.end() - 5, vec_ref.end());
+  vec_ref.insert(vec_ref.begin(), part.begin(), part.end());
+  check_equal(vec, vec_ref);
+
+  // assign reuses the buffer when it is large enough
+  auto data = vec.data();
+  vec.assign(more.begin(), more.end());
+  ASSERT_EQ(vec.data(), data);
+  check_equal(vec, more);
+  vec.assign(vec.begin() + 1, vec.end());
+  check_equal(vec, std::vector<int>({-2}));
+  auto in2 = std::istringstream("4 5");
+  vec.assign(std::istream_iterator<int>(in2), std::istream_iterator<int>());
+  check_equal(vec, std::vector<int>({4, 5}));
+
+  // existing elements are moved exactly once, new ones are copied exactly once
+  Tracked::reset();
+  {
+    auto tracked = vector<Tracked>();
+    tracked.reserve(10);
+    for (auto i = 0; i < 10; i++) {
+      tracked.emplace_back(i);
+    }
+    auto src = std::vector<Tracked>(100, Tracked(-1));
+    Tracked::reset();
+    tracked.insert(tracked.begin() + 5, src.begin(), src.end());
+    ASSERT_EQ(Tracked::moves, 10);
+    ASSERT_EQ(Tracked::copies, 100);
+    ASSERT_EQ(tracked[4].val_, 4);
+    ASSERT_EQ(tracked[5].val_, -1);
+    ASSERT_EQ(tracked[105].val_, 5);
+
+    Tracked::reset();
+    tracked.insert(tracked.begin() + 1, 200, Tracked(3));
+    ASSERT_EQ(Tracked::moves, 110);
+    ASSERT_EQ(Tracked::copies, 200);
+  }
+}
+
+TEST(VectorTests, TestShrinkToFit) {
+  auto vec = vector<string>();
+  for (auto i = 0; i < 100; i++) {
+    vec.push_back(string("s"));
+  }
+  ASSERT_EQ(vec.capacity(), 128);
+  ASSERT_GE(vec.max_size(), vec.capacity());
+  ASSERT_EQ(vec.max_size(), std::allocator_traits<std::allocator<string>>::max_size(vec.get_allocator()));
+
+  vec.erase(vec.begin() + 10, vec.end());
+  vec.shrink_to_fit();
+  ASSERT_EQ(vec.capacity(), 10);
+  ASSERT_EQ(vec.size(), 10);
+  ASSERT_TRUE(vec[9] == string("s"));
+  auto data = vec.data();
+  vec.shrink_to_fit();
+  ASSERT_EQ(vec.data(), data);
+
+  vec.clear();
+  vec.shrink_to_fit();
+  ASSERT_EQ(vec.capacity(), 0);
+  ASSERT_EQ(vec.data(), nullptr);
+  vec.push_back(string("t"));
+  ASSERT_EQ(vec.size(), 1);
+}
+
+TEST(VectorTests, TestSearch) {
+  auto vec = vector<int>();
+  auto vec_ref = std::vector<int>();
+  for (auto i = 0; i < 1000; i++) {
+    vec.push_back(i % 97);
+    vec_ref.push_back(i % 97);
+  }
+  for (auto v : {0, 42, 96, 97, -1}) {
+    ASSERT_EQ(vec.find(v) - vec.begin(), std::find(vec_ref.begin(), vec_ref.end(), v) - vec_ref.begin());
+    ASSERT_EQ(vec.count(v), std::count(vec_ref.begin(), vec_ref.end(), v));
+    ASSERT_EQ(vec.contains(v), std::find(vec_ref.begin(), vec_ref.end(), v) != vec_ref.end());
+  }
+  vec[500] = -5;
+  vec[600] = 200;
+  ASSERT_EQ(vec.min_element() - vec.begin(), 500);
+  ASSERT_EQ(vec.max_element() - vec.begin(), 600);
+
+  auto vec_c = vec;
+  ASSERT_TRUE(vec_c == vec);
+  vec_c[999] = -1;
+  ASSERT_TRUE(vec_c != vec);
+
+  // other types take the scalar loop
+  auto strs = vector<string>({string("a"), string("b"), string("a")});
+  ASSERT_EQ(strs.find(string("b")), strs.begin() + 1);
+  ASSERT_EQ(strs.count(string("a")), 2);
+  ASSERT_FALSE(strs.contains(string("c")));
+
+  auto empty = vector<int>();
+  ASSERT_EQ(empty.min_element(), empty.end());
+  ASSERT_EQ(empty.find(0), empty.end());
+}
+
+// a copy throws once copies_left reaches 0
+struct ThrowOnCopy {
+  static inline int alive = 0;
+  static inline int copies_left = -1;
+
+  int val_;
+
+  explicit ThrowOnCopy(int val) : val_(val) { alive++; }
+  ThrowOnCopy(const ThrowOnCopy &other) : val_(other.val_) {
+    if (copies_left == 0) {
+      throw std::exception();
+    }
+    copies_left--;
+    alive++;
+  }
+  ThrowOnCopy(ThrowOnCopy &&other) noexcept : val_(other.val_) { alive++; }
+  ~ThrowOnCopy() { alive--; }
+  ThrowOnCopy &operator=(const ThrowOnCopy &other) = default;
+};
+
+TEST(VectorTests, TestExceptionSafety) {
+  ThrowOnCopy::alive = 0;
+  {
+    auto vec = vector<ThrowOnCopy>();
+    auto other = vector<ThrowOnCopy>();
+    for (auto i = 0; i < 10; i++) {
+      vec.emplace_back(i);
+      other.emplace_back(-i);
+    }
+
+    // a failed copy assignment leaves the target as it was
+    ThrowOnCopy::copies_left = 5;
+    ASSERT_THROW(vec = other, std::exception);
+    ASSERT_EQ(vec.size(), 10);
+    ASSERT_EQ(vec[9].val_, 9);
+    ASSERT_EQ(ThrowOnCopy::alive, 20);
+
+    // so does a failed insertion, with and without reallocation
+    ThrowOnCopy::copies_left = -1;
+    auto src = std::vector<ThrowOnCopy>(other.begin(), other.end());
+    for (auto spare : {0, 100}) {
+      vec.reserve(vec.size() + spare);
+      ThrowOnCopy::copies_left = 5;
+      ASSERT_THROW(vec.insert(vec.begin() + 3, src.begin(), src.end()), std::exception);
+      ThrowOnCopy::copies_left = 5;
+      ASSERT_THROW(vec.insert(vec.begin() + 3, 10, other[1]), std::exception);
+      ASSERT_EQ(vec.size(), 10);
+      for (auto i = 0; i < 10; i++) {
+        ASSERT_EQ(vec[i].val_, i);
+      }
+      ASSERT_EQ(ThrowOnCopy::alive, 30);
+    }
+
+    // and so does a failed push or emplace that had to grow the buffer
+    vec.shrink_to_fit();
+    ThrowOnCopy::copies_left = 0;
+    ASSERT_THROW(vec.push_back(other[1]), std::exception);
+    ASSERT_THROW(vec.emplace(vec.begin(), other[1]), std::exception);
+    ASSERT_EQ(vec.size(), 10);
+    ASSERT_EQ(vec.capacity(), 10);
+    ASSERT_EQ(vec[0].val_, 0);
+    ASSERT_EQ(ThrowOnCopy::alive, 30);
+    ThrowOnCopy::copies_left = -1;
+  }
+  ASSERT_EQ(ThrowOnCopy::alive, 0);
+}
+
+// stateful allocator that stays with its container on move assignment
+template <typename T>
+struct tagged_allocator : std::allocator<T> {
+  using is_always_equal = std::false_type;
+  using propagate_on_container_move_assignment = std::false_type;
+
+  template <typename U>
+  struct rebind {
+    using other = tagged_allocator<U>;
+  };
+
+  int tag_ = 0;
+
+  tagged_allocator() = default;
+  explicit tagged_allocator(int tag) : tag_(tag) {}
+  template <typename U>
+  tagged_allocator(const tagged_allocator<U> &other) : tag_(other.tag_) {}
+
+  bool operator==(const tagged_allocator &other) const { return tag_ == other.tag_; }
+  bool operator!=(const tagged_allocator &other) const { return tag_ != other.tag_; }
+};
+
+TEST(VectorTests, TestMoveAssignAllocator) {
+  using tagged = vector<std::string, growth::doubling, tagged_allocator<std::string>>;
+  // moving between unequal allocators allocates, so it may throw
+  static_assert(std::is_nothrow_move_assignable_v<vector<std::string>>);
+  static_assert(!std::is_nothrow_move_assignable_v<tagged>);
+
+  auto vec = tagged(tagged_allocator<std::string>(1));
+  auto other = tagged(tagged_allocator<std::string>(2));
+  for (auto i = 0; i < 10; i++) {
+    other.push_back(std::to_string(i));
+  }
+  vec = std::move(other);
+  ASSERT_EQ(vec.size(), 10);
+  ASSERT_EQ(vec[9], "9");
+  ASSERT_EQ(vec.get_allocator().tag_, 1);
+}
+
 }  // namespace STL